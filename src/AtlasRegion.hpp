@@ -0,0 +1,26 @@
+#ifndef TERRA_ATLASREGION_HPP
+#define TERRA_ATLASREGION_HPP
+
+#include <memory>
+#include <SFML/Graphics.hpp>
+
+namespace terra{
+	/*!
+	 * \brief Atlas Region
+	 *
+	 * A structure describing where an image was packed into a texture atlas.
+	 */
+	struct AtlasRegion{
+		/*!
+		 * The atlas page that holds the image.
+		 */
+		std::shared_ptr<sf::Image> Page;
+
+		/*!
+		 * The area of the page covered by the image.
+		 */
+		sf::IntRect Rect;
+	};
+}
+
+#endif
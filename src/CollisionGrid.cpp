@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include "CollisionGrid.hpp"
+
+namespace{
+	// The bits from First up to but not including Last
+	uint64_t Mask(unsigned int First, unsigned int Last){
+		return (Last == 64 ? ~uint64_t(0) : (uint64_t(1) << Last)-1) & ~((uint64_t(1) << First)-1);
+	}
+
+	unsigned int CountTrailingZeros(uint64_t Word){
+#ifdef __GNUC__
+		return __builtin_ctzll(Word);
+#else
+		unsigned int Count = 0;
+		for (; !(Word & 1); Word >>= 1)
+			++Count;
+		return Count;
+#endif
+	}
+}
+
+terra::CollisionGrid::CollisionGrid(){
+	Columns = 0;
+	Rows = 0;
+	Stride = 0;
+}
+
+bool terra::CollisionGrid::ClipArea(const sf::FloatRect &Area, unsigned int &Column, unsigned int &Row, unsigned int &Width, unsigned int &Height) const{
+	if (CellSize.x == 0 || CellSize.y == 0)
+		return false;
+
+	// A cell only counts if the area reaches into it, but an area with no size still checks the cell it is in
+	double Left = std::floor(double(Area.Left)/CellSize.x);
+	double Top = std::floor(double(Area.Top)/CellSize.y);
+	double Right = std::max(std::ceil(double(Area.Left+Area.Width)/CellSize.x), Left+1);
+	double Bottom = std::max(std::ceil(double(Area.Top+Area.Height)/CellSize.y), Top+1);
+	if (Right <= 0 || Bottom <= 0 || Left >= Columns || Top >= Rows)
+		return false;
+	Left = std::max(Left, 0.);
+	Top = std::max(Top, 0.);
+	Column = Left;
+	Row = Top;
+	Width = std::min<double>(Right, Columns)-Left;
+	Height = std::min<double>(Bottom, Rows)-Top;
+	return true;
+}
+
+bool terra::CollisionGrid::ClipCells(unsigned int &Column, unsigned int &Row, unsigned int &Width, unsigned int &Height) const{
+	if (Column >= Columns || Row >= Rows || Width == 0 || Height == 0)
+		return false;
+	Width = std::min(Width, Columns-Column);
+	Height = std::min(Height, Rows-Row);
+	return true;
+}
+
+void terra::CollisionGrid::Fill(unsigned int Column, unsigned int Row, unsigned int Width, unsigned int Height, bool Solid){
+	if (!ClipCells(Column, Row, Width, Height))
+		return;
+
+	// Whole words are filled at once, with only the words at each end of the run masked
+	unsigned int FirstWord = Column/64;
+	unsigned int LastWord = (Column+Width-1)/64;
+	for (unsigned int y = Row; y < Row+Height; ++y)
+		for (unsigned int x = FirstWord; x <= LastWord; ++x){
+			uint64_t Bits = Mask(x == FirstWord ? Column%64 : 0, x == LastWord ? (Column+Width-1)%64+1 : 64);
+			if (Solid)
+				Words[y*Stride+x] |= Bits;
+			else
+				Words[y*Stride+x] &= ~Bits;
+		}
+}
+
+const unsigned int terra::CollisionGrid::FindRunEnd(unsigned int Column, unsigned int Row) const{
+	if (Column >= Columns || Row >= Rows)
+		return Columns;
+
+	// Flip the words so the cells that differ from the first are set, then look for the first set bit
+	const uint64_t *Line = &Words[Row*Stride];
+	uint64_t Flip = IsSolid(Column, Row) ? ~uint64_t(0) : 0;
+	unsigned int Word = Column/64;
+	uint64_t Bits = (Line[Word]^Flip) & Mask(Column%64, 64);
+	while (Bits == 0){
+		if (++Word == Stride)
+			return Columns;
+		Bits = Line[Word]^Flip;
+	}
+	return std::min(Word*64+CountTrailingZeros(Bits), Columns);
+}
+
+const sf::Vector2<unsigned int> &terra::CollisionGrid::GetCellSize() const{
+	return CellSize;
+}
+
+const unsigned int terra::CollisionGrid::GetColumns() const{
+	return Columns;
+}
+
+const unsigned int terra::CollisionGrid::GetRows() const{
+	return Rows;
+}
+
+const unsigned int terra::CollisionGrid::GetStride() const{
+	return Stride;
+}
+
+const std::vector<uint64_t> &terra::CollisionGrid::GetWords() const{
+	return Words;
+}
+
+const bool terra::CollisionGrid::IsAnySolid(unsigned int Column, unsigned int Row, unsigned int Width, unsigned int Height) const{
+	if (!ClipCells(Column, Row, Width, Height))
+		return false;
+	unsigned int FirstWord = Column/64;
+	unsigned int LastWord = (Column+Width-1)/64;
+	for (unsigned int y = Row; y < Row+Height; ++y)
+		for (unsigned int x = FirstWord; x <= LastWord; ++x)
+			if (Words[y*Stride+x] & Mask(x == FirstWord ? Column%64 : 0, x == LastWord ? (Column+Width-1)%64+1 : 64))
+				return true;
+	return false;
+}
+
+const bool terra::CollisionGrid::IsAreaSolid(const sf::FloatRect &Area) const{
+	unsigned int Column, Row, Width, Height;
+	return ClipArea(Area, Column, Row, Width, Height) && IsAnySolid(Column, Row, Width, Height);
+}
+
+const bool terra::CollisionGrid::IsLineSolid(const sf::Vector2f &From, const sf::Vector2f &To, sf::Vector2f *Hit) const{
+	if (CellSize.x == 0 || CellSize.y == 0)
+		return false;
+
+	// Walk the cells the line passes through in order, always crossing whichever cell edge the line reaches first
+	sf::Vector2f Delta = To-From;
+	int X = std::floor(From.x/CellSize.x);
+	int Y = std::floor(From.y/CellSize.y);
+	int EndX = std::floor(To.x/CellSize.x);
+	int EndY = std::floor(To.y/CellSize.y);
+	int StepX = Delta.x > 0 ? 1 : (Delta.x < 0 ? -1 : 0);
+	int StepY = Delta.y > 0 ? 1 : (Delta.y < 0 ? -1 : 0);
+	float Infinity = std::numeric_limits<float>::infinity();
+	float NextX = StepX != 0 ? ((X+(StepX > 0 ? 1 : 0))*float(CellSize.x)-From.x)/Delta.x : Infinity;
+	float NextY = StepY != 0 ? ((Y+(StepY > 0 ? 1 : 0))*float(CellSize.y)-From.y)/Delta.y : Infinity;
+	float StepLengthX = StepX != 0 ? CellSize.x/std::fabs(Delta.x) : Infinity;
+	float StepLengthY = StepY != 0 ? CellSize.y/std::fabs(Delta.y) : Infinity;
+	float Distance = 0;
+
+	// Rounding can't make the walk run forever, it takes exactly one step per cell edge crossed
+	unsigned int Steps = std::abs(EndX-X)+std::abs(EndY-Y);
+	for (unsigned int i = 0; ; ++i){
+		if (IsSolid(X, Y)){
+			if (Hit != nullptr)
+				*Hit = From+Delta*Distance;
+			return true;
+		}
+		if (i == Steps)
+			return false;
+		if (NextX < NextY){
+			Distance = NextX;
+			X += StepX;
+			NextX += StepLengthX;
+		}
+		else{
+			Distance = NextY;
+			Y += StepY;
+			NextY += StepLengthY;
+		}
+	}
+}
+
+const bool terra::CollisionGrid::IsSolid(unsigned int Column, unsigned int Row) const{
+	return Column < Columns && Row < Rows && (Words[Row*Stride+Column/64] >> (Column%64) & 1);
+}
+
+const bool terra::CollisionGrid::IsSolidAt(const sf::Vector2f &Point) const{
+	if (CellSize.x == 0 || CellSize.y == 0 || Point.x < 0 || Point.y < 0)
+		return false;
+	return IsSolid(Point.x/CellSize.x, Point.y/CellSize.y);
+}
+
+void terra::CollisionGrid::Reset(unsigned int NewColumns, unsigned int NewRows, const sf::Vector2<unsigned int> &NewCellSize, const char *Bits){
+	CellSize = NewCellSize;
+	Columns = NewColumns;
+	Rows = NewRows;
+	Stride = (Columns+63)/64;
+	Words.assign(Stride*Rows, 0);
+	if (Bits == nullptr || Words.empty())
+		return;
+
+	// Cells past the end of each row have to stay empty, or runs would carry on past it
+	memcpy(&Words[0], Bits, Words.size()*sizeof(uint64_t));
+	if (Columns%64 != 0)
+		for (unsigned int y = 0; y < Rows; ++y)
+			Words[y*Stride+Stride-1] &= Mask(0, Columns%64);
+}
@@ -0,0 +1,134 @@
+#ifndef TERRA_COLLISIONGRID_HPP
+#define TERRA_COLLISIONGRID_HPP
+
+#include <cstdint>
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+namespace terra{
+	/*!
+	 * \brief A grid of solid cells
+	 *
+	 * The cells of an Ogmo grid layer, packed one bit per cell. Each row starts on a new 64 bit word, so checks along a row test 64 cells at a time. Cells outside the grid are never solid.
+	 *
+	 * Queries come in two forms: ones taking cells, and ones taking positions in the world, which are divided by the size of a cell first.
+	 */
+	class CollisionGrid{
+		private:
+			sf::Vector2<unsigned int> CellSize;
+			unsigned int Columns;
+			unsigned int Rows;
+			unsigned int Stride;
+			std::vector<uint64_t> Words;
+			bool ClipCells(unsigned int &Column, unsigned int &Row, unsigned int &Width, unsigned int &Height) const;
+			bool ClipArea(const sf::FloatRect &Area, unsigned int &Column, unsigned int &Row, unsigned int &Width, unsigned int &Height) const;
+		public:
+			/*!
+			 * Create an empty grid.
+			 */
+			CollisionGrid();
+
+			/*!
+			 * \param Column The first column of the cells
+			 * \param Row The first row of the cells
+			 * \param Width The number of columns to fill
+			 * \param Height The number of rows to fill
+			 * \param Solid Whether the cells become solid or empty
+			 *
+			 * Make a rectangle of cells solid or empty. The part of it outside the grid is ignored.
+			 */
+			void Fill(unsigned int Column, unsigned int Row, unsigned int Width, unsigned int Height, bool Solid = true);
+
+			/*!
+			 * \param Column The column to start from
+			 * \param Row The row to search
+			 * \return The first column after Column that is not the same as it, or the number of columns if the rest of the row is the same
+			 *
+			 * Find where a run of solid or empty cells in a row ends. Walking a row run by run is how a grid is turned into collision boxes.
+			 */
+			const unsigned int FindRunEnd(unsigned int Column, unsigned int Row) const;
+
+			/*!
+			 * \return The size of a cell in the world
+			 */
+			const sf::Vector2<unsigned int> &GetCellSize() const;
+
+			/*!
+			 * \return The number of columns
+			 */
+			const unsigned int GetColumns() const;
+
+			/*!
+			 * \return The number of rows
+			 */
+			const unsigned int GetRows() const;
+
+			/*!
+			 * \return The number of words in each row
+			 */
+			const unsigned int GetStride() const;
+
+			/*!
+			 * \return The cells, a row at a time, with the first cell of each row in the lowest bit of its first word
+			 */
+			const std::vector<uint64_t> &GetWords() const;
+
+			/*!
+			 * \param Column The first column of the cells
+			 * \param Row The first row of the cells
+			 * \param Width The number of columns to check
+			 * \param Height The number of rows to check
+			 * \return True if any of the cells is solid, false otherwise
+			 *
+			 * Check a rectangle of cells.
+			 */
+			const bool IsAnySolid(unsigned int Column, unsigned int Row, unsigned int Width, unsigned int Height) const;
+
+			/*!
+			 * \param Area The area in the world
+			 * \return True if any cell overlapping the area is solid, false otherwise
+			 *
+			 * Check an area of the world, such as an object's bounding box. Cells the area only touches on their edge don't count.
+			 */
+			const bool IsAreaSolid(const sf::FloatRect &Area) const;
+
+			/*!
+			 * \param From The start of the line in the world
+			 * \param To The end of the line in the world
+			 * \param Hit Set to where the line first enters a solid cell, if it does and this isn't a null pointer
+			 * \return True if the line passes through a solid cell, false otherwise
+			 *
+			 * Check a line through the world, one cell at a time from its start, for line of sight or fast moving objects.
+			 */
+			const bool IsLineSolid(const sf::Vector2f &From, const sf::Vector2f &To, sf::Vector2f *Hit = nullptr) const;
+
+			/*!
+			 * \param Column The column of the cell
+			 * \param Row The row of the cell
+			 * \return True if the cell is solid, false otherwise
+			 *
+			 * Check a single cell.
+			 */
+			const bool IsSolid(unsigned int Column, unsigned int Row) const;
+
+			/*!
+			 * \param Point The point in the world
+			 * \return True if the cell holding the point is solid, false otherwise
+			 *
+			 * Check a single point of the world.
+			 */
+			const bool IsSolidAt(const sf::Vector2f &Point) const;
+
+			/*!
+			 * \param NewColumns The number of columns
+			 * \param NewRows The number of rows
+			 * \param NewCellSize The size of a cell in the world
+			 * \param Bits The cells laid out as GetWords() returns them, or a null pointer to make every cell empty
+			 *
+			 * Resize the grid, replacing all of its cells.
+			 */
+			void Reset(unsigned int NewColumns, unsigned int NewRows, const sf::Vector2<unsigned int> &NewCellSize, const char *Bits = nullptr);
+	};
+}
+
+#endif
@@ -0,0 +1,82 @@
+#include "CommandList.hpp"
+
+terra::CommandList::CommandList(unsigned int Width, unsigned int Height) : Null(Width, Height){
+}
+
+void terra::CommandList::Clear(const sf::Color &Color){
+	Command NewCommand;
+	NewCommand.Type = Command::Clear;
+	NewCommand.Color = Color;
+	Commands.push_back(NewCommand);
+}
+
+void terra::CommandList::DrawQuads(const sf::Image *Texture, const terra::Vertex *NewVertices, unsigned int VertexCount, sf::Blend::Mode Blend){
+	if (!VertexCount)
+		return;
+
+	// Merge with the previous draw if nothing changed in between
+	bool Merged = Commands.size() && Commands.back().Type == Command::Draw && Commands.back().Texture == Texture && Commands.back().Blend == Blend;
+	Count(Texture, VertexCount, !Merged);
+	if (!Merged){
+		Command NewCommand;
+		NewCommand.Type = Command::Draw;
+		NewCommand.Texture = Texture;
+		NewCommand.Blend = Blend;
+		NewCommand.First = Vertices.size();
+		NewCommand.Count = 0;
+		Commands.push_back(NewCommand);
+	}
+	Vertices.insert(Vertices.end(), NewVertices, NewVertices+VertexCount);
+	Commands.back().Count += VertexCount;
+}
+
+unsigned int terra::CommandList::GetCommandCount() const{
+	return Commands.size();
+}
+
+const unsigned int terra::CommandList::GetIgnoredCount() const{
+	return Null.GetIgnoredCount();
+}
+
+sf::RenderTarget &terra::CommandList::GetTarget(){
+	return Null;
+}
+
+const sf::View &terra::CommandList::GetView() const{
+	return Null.GetView();
+}
+
+const bool terra::CommandList::IsHardware() const{
+	return false;
+}
+
+void terra::CommandList::Replay(terra::RenderBackend &Backend) const{
+	for (auto i = Commands.begin(); i != Commands.end(); ++i){
+		if (i->Type == Command::Clear)
+			Backend.Clear(i->Color);
+		else if (i->Type == Command::Draw)
+			Backend.DrawQuads(i->Texture, &Vertices[i->First], i->Count, i->Blend);
+		else
+			Backend.SetView(Views[i->First]);
+	}
+}
+
+void terra::CommandList::Reset(unsigned int Width, unsigned int Height){
+	Commands.clear();
+	Vertices.clear();
+	Views.clear();
+	Null.SetSize(Width, Height);
+}
+
+void terra::CommandList::SetView(const sf::View &View){
+	// Views are kept on the side, since they're much bigger than any other command
+	Command NewCommand;
+	NewCommand.Type = Command::View;
+	NewCommand.First = Views.size();
+	Commands.push_back(NewCommand);
+	Views.push_back(View);
+	Null.SetView(View);
+}
+
+terra::CommandList::~CommandList(){
+}
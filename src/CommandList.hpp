@@ -0,0 +1,124 @@
+#ifndef TERRA_COMMANDLIST_HPP
+#define TERRA_COMMANDLIST_HPP
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "NullTarget.hpp"
+#include "RenderBackend.hpp"
+
+namespace terra{
+	/*!
+	 * \brief A recorded list of draw commands
+	 *
+	 * A render backend which doesn't draw anything, but records what was drawn onto it so that it can be replayed onto another backend later, possibly from another thread. Quads are copied when they are recorded, but textures are only pointed to, so they must stay alive until the list has been replayed.
+	 */
+	class CommandList : public RenderBackend{
+		private:
+			struct Command{
+				enum Kind{
+					Clear,
+					Draw,
+					View
+				};
+				Kind Type;
+				const sf::Image *Texture;
+				sf::Blend::Mode Blend;
+				sf::Color Color;
+				unsigned int First;
+				unsigned int Count;
+			};
+			std::vector<Command> Commands;
+			std::vector<Vertex> Vertices;
+			std::vector<sf::View> Views;
+			NullTarget Null;
+		public:
+			/*!
+			 * \param Width The width of the target the list will be replayed onto
+			 * \param Height The height of the target the list will be replayed onto
+			 *
+			 * Create a new, empty command list.
+			 */
+			CommandList(unsigned int Width = 0, unsigned int Height = 0);
+
+			/*!
+			 * \param Color The color to clear to
+			 *
+			 * Record clearing the whole target to a single color.
+			 */
+			void Clear(const sf::Color &Color = sf::Color::Black);
+
+			/*!
+			 * \param Texture The texture to draw from, or a null pointer to draw plain colored quads
+			 * \param Vertices An array of vertices, four per quad
+			 * \param VertexCount The number of vertices in the array
+			 * \param Blend The blend mode to draw with
+			 *
+			 * Record drawing a list of quads. Consecutive draws with the same texture and blend mode are merged into one.
+			 */
+			void DrawQuads(const sf::Image *Texture, const Vertex *Vertices, unsigned int VertexCount, sf::Blend::Mode Blend = sf::Blend::Alpha);
+
+			/*!
+			 * \return The number of recorded commands
+			 *
+			 * Retrieve the number of recorded commands.
+			 */
+			unsigned int GetCommandCount() const;
+
+			/*!
+			 * \return The number of SFML drawables drawn onto the target from GetTarget()
+			 *
+			 * Retrieve how many draws couldn't be recorded since the list was created.
+			 */
+			const unsigned int GetIgnoredCount() const;
+
+			/*!
+			 * \return A target that ignores everything drawn onto it
+			 *
+			 * SFML drawables can't be recorded, so items have to submit their sprites and text to the engine's sprite batcher to be seen. Anything drawn onto the target is counted by GetIgnoredCount().
+			 */
+			sf::RenderTarget &GetTarget();
+
+			/*!
+			 * \return The current view
+			 *
+			 * Retrieve the view that the last recorded commands are drawn through.
+			 */
+			const sf::View &GetView() const;
+
+			/*!
+			 * \return Always false
+			 *
+			 * Recorded lists can't draw images that only live on the graphics card, since those could be changed before the list is replayed.
+			 */
+			const bool IsHardware() const;
+
+			/*!
+			 * \param Backend The backend to replay the commands onto
+			 *
+			 * Replay every recorded command, in order, onto another backend.
+			 */
+			void Replay(RenderBackend &Backend) const;
+
+			/*!
+			 * \param Width The width of the target the list will be replayed onto
+			 * \param Height The height of the target the list will be replayed onto
+			 *
+			 * Throw out every recorded command, keeping the memory around for the next frame.
+			 */
+			void Reset(unsigned int Width, unsigned int Height);
+
+			/*!
+			 * \param View The new view
+			 *
+			 * Record changing the view that later commands are drawn through.
+			 */
+			void SetView(const sf::View &View);
+
+			/*!
+			 * Destroy the command list.
+			 */
+			~CommandList();
+	};
+}
+
+#endif
@@ -0,0 +1,140 @@
+#include "ConsoleText.hpp"
+
+terra::ConsoleText::ConsoleText(const sf::Font &NewFont) : Font(NewFont){
+	LogSize = 0;
+	Width = 0;
+	Height = 0;
+	ImageWidth = 0;
+	ImageHeight = 0;
+	ScrollOffset = 0;
+	Dirty = true;
+}
+
+void terra::ConsoleText::AddLine(const std::string &Line, const sf::Color &Color, float Y){
+	// Lay the glyphs out along the baseline the same way sf::Text does
+	const sf::Image &Image = Font.GetImage(CharacterSize);
+	float X = 2.;
+	float Baseline = Y+CharacterSize;
+	sf::Uint32 Previous = 0;
+	for (auto i = Line.begin(); i != Line.end(); ++i){
+		sf::Uint32 Current = static_cast<unsigned char>(*i);
+		X += Font.GetKerning(Previous, Current, CharacterSize);
+		Previous = Current;
+		const sf::Glyph &Glyph = Font.GetGlyph(Current, CharacterSize, false);
+
+		// Only visible glyphs need a quad
+		if (Glyph.Bounds.Width && Glyph.Bounds.Height){
+			sf::FloatRect Coords = Image.GetTexCoords(Glyph.SubRect);
+			float Left = X+Glyph.Bounds.Left;
+			float Top = Baseline+Glyph.Bounds.Top;
+			float Right = Left+Glyph.Bounds.Width;
+			float Bottom = Top+Glyph.Bounds.Height;
+			terra::Vertex Corner;
+			Corner.Color = Color;
+			Corner.Position = sf::Vector2f(Left, Top);
+			Corner.TexCoords = sf::Vector2f(Coords.Left, Coords.Top);
+			Vertices.push_back(Corner);
+			Corner.Position = sf::Vector2f(Left, Bottom);
+			Corner.TexCoords = sf::Vector2f(Coords.Left, Coords.Top+Coords.Height);
+			Vertices.push_back(Corner);
+			Corner.Position = sf::Vector2f(Right, Bottom);
+			Corner.TexCoords = sf::Vector2f(Coords.Left+Coords.Width, Coords.Top+Coords.Height);
+			Vertices.push_back(Corner);
+			Corner.Position = sf::Vector2f(Right, Top);
+			Corner.TexCoords = sf::Vector2f(Coords.Left+Coords.Width, Coords.Top);
+			Vertices.push_back(Corner);
+		}
+		X += Glyph.Advance;
+
+		// Nothing past the right edge can be seen
+		if (X > Width)
+			break;
+	}
+}
+
+void terra::ConsoleText::Draw(terra::RenderBackend &Backend) const{
+	if (!Vertices.empty())
+		Backend.DrawQuads(&Font.GetImage(CharacterSize), &Vertices[0], Vertices.size());
+}
+
+void terra::ConsoleText::Invalidate(){
+	Dirty = true;
+}
+
+void terra::ConsoleText::Rebuild(const std::list<std::pair<unsigned int, std::string>> &Log){
+	// Split the log into display lines, newest first, stopping once the visible lines have been found
+	unsigned int LineMax = Height/LineHeight;
+	std::vector<std::pair<unsigned int, std::string>> Lines;
+	for (auto i = Log.rbegin(); i != Log.rend() && Lines.size() < LineMax+ScrollOffset; ++i){
+		std::vector<std::string> Pieces;
+		std::string::size_type Start = 0;
+		while (Start < i->second.size()){
+			std::string::size_type End = i->second.find('\n', Start);
+			if (End == std::string::npos)
+				End = i->second.size();
+			Pieces.push_back(i->second.substr(Start, End-Start));
+			Start = End+1;
+		}
+		if (Pieces.empty())
+			Pieces.push_back("");
+		for (auto j = Pieces.rbegin(); j != Pieces.rend(); ++j)
+			Lines.push_back(std::pair<unsigned int, std::string>(i->first, *j));
+	}
+
+	// Don't scroll past the oldest line
+	if (ScrollOffset+LineMax > Lines.size())
+		ScrollOffset = Lines.size() > LineMax ? Lines.size()-LineMax : 0;
+
+	// Load every glyph first, since loading new glyphs can resize the font's image and move the old ones
+	for (unsigned int i = ScrollOffset; i < Lines.size() && i < ScrollOffset+LineMax; ++i)
+		for (auto j = Lines[i].second.begin(); j != Lines[i].second.end(); ++j)
+			Font.GetGlyph(static_cast<unsigned char>(*j), CharacterSize, false);
+	ImageWidth = Font.GetImage(CharacterSize).GetWidth();
+	ImageHeight = Font.GetImage(CharacterSize).GetHeight();
+
+	// Then lay out the visible lines from the bottom up, color coding warnings and errors
+	Vertices.clear();
+	for (unsigned int i = ScrollOffset; i < Lines.size() && i < ScrollOffset+LineMax; ++i){
+		sf::Color Color = sf::Color::White;
+		if (Lines[i].first == 1)
+			Color = sf::Color::Yellow;
+		else if (Lines[i].first == 2)
+			Color = sf::Color::Red;
+		AddLine(Lines[i].second, Color, static_cast<float>(Height)-(i-ScrollOffset+1)*LineHeight);
+	}
+	Dirty = false;
+}
+
+void terra::ConsoleText::Scroll(int Lines){
+	// Scrolling past the oldest line is caught on the next rebuild
+	if (Lines < 0 && static_cast<unsigned int>(-Lines) > ScrollOffset)
+		ScrollOffset = 0;
+	else
+		ScrollOffset += Lines;
+	Dirty = true;
+}
+
+void terra::ConsoleText::ScrollToEnd(){
+	ScrollOffset = 0;
+	Dirty = true;
+}
+
+void terra::ConsoleText::Update(const std::list<std::pair<unsigned int, std::string>> &Log, unsigned int NewWidth, unsigned int NewHeight){
+	// The log only ever grows, so a change in size means new messages
+	if (Log.size() != LogSize || NewWidth != Width || NewHeight != Height)
+		Dirty = true;
+
+	// Somebody else may have loaded glyphs into the font, moving the ones we use
+	if (Font.GetImage(CharacterSize).GetWidth() != ImageWidth || Font.GetImage(CharacterSize).GetHeight() != ImageHeight)
+		Dirty = true;
+
+	if (!Dirty)
+		return;
+	LogSize = Log.size();
+	Width = NewWidth;
+	Height = NewHeight;
+	Rebuild(Log);
+}
+
+terra::ConsoleText::~ConsoleText(){
+}
@@ -0,0 +1,89 @@
+#ifndef TERRA_CONSOLETEXT_HPP
+#define TERRA_CONSOLETEXT_HPP
+
+#include <list>
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+#include "RenderBackend.hpp"
+#include "Vertex.hpp"
+
+namespace terra{
+	/*!
+	 * \brief The console's text
+	 *
+	 * The laid out text of the console log. The glyphs of every visible line are kept in a single vertex list, which is only rebuilt when the log, the window size, or the scroll position changes.
+	 */
+	class ConsoleText{
+		private:
+			const sf::Font &Font;
+			std::vector<Vertex> Vertices;
+			unsigned int LogSize;
+			unsigned int Width;
+			unsigned int Height;
+			unsigned int ImageWidth;
+			unsigned int ImageHeight;
+			unsigned int ScrollOffset;
+			bool Dirty;
+			void AddLine(const std::string &Line, const sf::Color &Color, float Y);
+			void Rebuild(const std::list<std::pair<unsigned int, std::string>> &Log);
+		public:
+			/*!
+			 * The size of the console's characters, in pixels.
+			 */
+			static const unsigned int CharacterSize = 16;
+
+			/*!
+			 * The height of each line of the console, in pixels.
+			 */
+			static const unsigned int LineHeight = 20;
+
+			/*!
+			 * \param NewFont The font to draw the text with, which must outlive the console text
+			 *
+			 * Create the console's text.
+			 */
+			ConsoleText(const sf::Font &NewFont);
+
+			/*!
+			 * \param Backend The backend to draw onto
+			 *
+			 * Draw the console's text as it was last laid out.
+			 */
+			void Draw(RenderBackend &Backend) const;
+
+			/*!
+			 * Force the text to be laid out again on the next update, for logs whose lines change without the log growing.
+			 */
+			void Invalidate();
+
+			/*!
+			 * \param Lines The number of lines to scroll, positive to scroll back through older lines and negative to scroll forward
+			 *
+			 * Scroll through the console log.
+			 */
+			void Scroll(int Lines);
+
+			/*!
+			 * Scroll back to the newest lines of the console log.
+			 */
+			void ScrollToEnd();
+
+			/*!
+			 * \param Log The console log
+			 * \param NewWidth The width of the area the console is drawn in
+			 * \param NewHeight The height of the area the console is drawn in
+			 *
+			 * Lay the visible lines of the console log out again if anything has changed since the last update.
+			 */
+			void Update(const std::list<std::pair<unsigned int, std::string>> &Log, unsigned int NewWidth, unsigned int NewHeight);
+
+			/*!
+			 * Destroy the console's text.
+			 */
+			~ConsoleText();
+	};
+}
+
+#endif
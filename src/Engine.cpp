@@ -1,31 +1,327 @@
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <set>
+#include <sstream>
 #include <vector>
+#include "ConsoleText.hpp"
 #include "Engine.hpp"
+#include "InflateBuffer.hpp"
 #include "Item.hpp"
+#include "LevelLayerParser.hpp"
+#include "LevelFile.hpp"
 #include "OgmoTile.hpp"
+#include "PackFile.hpp"
+#include "ProjectFile.hpp"
+#include "RenderThread.hpp"
+#include "TargetBackend.hpp"
+#include "ThreadPool.hpp"
 #include "Tile.hpp"
 #include "Utilities.hpp"
+#include "XMLReader.hpp"
+
+namespace{
+	// Levels larger than this are streamed rather than parsed into a DOM, giving up parallel layer parsing for bounded memory
+	const unsigned long StreamingSize = 8*1024*1024;
+
+	// The default memory budget for parsed levels kept around for when they are loaded again
+	const unsigned long LevelCacheBudget = 32*1024*1024;
+
+	// Quotes, backslashes, and control characters can't appear in a JSON string as they are
+	std::string EscapeJSON(const std::string &Text){
+		std::string Escaped;
+		for (auto i = Text.begin(); i != Text.end(); ++i){
+			unsigned char Current = *i;
+			if (Current == '"' || Current == '\\'){
+				Escaped += '\\';
+				Escaped += Current;
+			}
+			else if (Current < 0x20){
+				const char *Digits = "0123456789abcdef";
+				Escaped += "\\u00";
+				Escaped += Digits[Current >> 4];
+				Escaped += Digits[Current & 0xF];
+			}
+			else
+				Escaped += Current;
+		}
+		return Escaped;
+	}
+
+	bool HasLayer(const terra::ProjectData &Project, const std::string &Name){
+		for (auto i = Project.Layers.begin(); i != Project.Layers.end(); ++i)
+			if (i->Name == Name)
+				return true;
+		return false;
+	}
+}
 
-terra::Engine::Engine(){
+terra::Engine::Engine() : ParsedLevels(LevelCacheBudget){
 	// Just setting up some variables
+	Compiling = false;
 	ConsoleOpen = false;
+	DespawnRadius = 0.;
+	DirtyRendering = false;
+	FullyDirty = true;
+	HasDirtyArea = false;
+	Headless = false;
+	HeadlessFrames = 100;
 	Initialized = false;
+	OcclusionDeferred = false;
+	ShowStats = false;
+	SnapshotTaken = false;
+	SpawnRadius = -1.;
+	ThreadedRendering = false;
+}
+
+void terra::Engine::AnimateTiles(float Elapsed){
+	// Tiles changing frames can't be tracked one by one, so dirty rendering redraws everything
+	unsigned int Version = TileAnimations.GetVersion();
+	TileAnimations.Update(Elapsed);
+	if (TileAnimations.GetVersion() != Version)
+		Invalidate();
+}
+
+void terra::Engine::BuildAtlas(){
+	// Queue every image used by the project
+	for (auto i = OgmoTilesets.begin(); i != OgmoTilesets.end(); ++i)
+		Atlas.Add(i->second.Image, GetTexture(i->second.Image));
+	for (auto i = OgmoObjects.begin(); i != OgmoObjects.end(); ++i)
+		if (i->second.Image.size())
+			Atlas.Add(i->second.Image, GetTexture(i->second.Image));
+
+	// Then pack them all at once. The originals stay loaded, since downscaled tilesets, the occlusion mask, and items drawing their own sprites still read them, so packed images cost their memory twice.
+	Atlas.Build();
+}
+
+void terra::Engine::BuildLevel(const terra::LevelData &Level){
+	// Set the level's values
+	for (auto i = Level.Values.begin(); i != Level.Values.end(); ++i){
+		if (LevelValues.find(i->first) == LevelValues.end()){
+			Warning(std::string("Level value of name \"") + i->first + "\" does not exist\n");
+			continue;
+		}
+		LevelValues[i->first] = i->second;
+	}
+
+	// Turn the layers' tiles and objects into items, leaving the occlusion mask until every layer is filled
+	OcclusionDeferred = true;
+	for (auto i = Level.Layers.begin(); i != Level.Layers.end(); ++i){
+		if (NamedLayers.find(i->Name) == NamedLayers.end()){
+			Warning(std::string("Layer of name \"") + i->Name + "\" does not exist\n");
+			continue;
+		}
+		std::shared_ptr<terra::Layer> Target = NamedLayers[i->Name];
+
+		// Grids are kept by the engine rather than the layer
+		if (Target->GetStoredType() == terra::Item::Grid)
+			Grids[i->Name] = i->Grid;
+
+		// Tiles go in as they are
+		if (Target->GetStoredType() == terra::Item::Tile)
+			for (auto j = i->Tiles.begin(); j != i->Tiles.end(); ++j)
+				Target->AddItem(std::shared_ptr<terra::Item>(new terra::Tile(*j)));
+
+		// Objects are laid over their definition and handed to their callback
+		if (Target->GetStoredType() == terra::Item::Object)
+			for (auto j = i->Objects.begin(); j != i->Objects.end(); ++j){
+				// Validate that the object is registered and still exists, compiled levels can hold objects the game never registered
+				if (Callbacks.find(j->Name) == Callbacks.end()){
+					Warning(std::string("Object of name \"") + j->Name + "\" is not registered\n");
+					continue;
+				}
+				if (OgmoObjects.find(j->Name) == OgmoObjects.end()){
+					Warning(std::string("Object of name \"") + j->Name + "\" does not exist\n");
+					continue;
+				}
+
+				// Insert the object, or leave it for the spawner until the view comes near
+				if (Spawner.IsEnabled() && EagerObjects.find(j->Name) == EagerObjects.end())
+					Spawner.Add(*j, Target);
+				else
+					Target->AddItem(CreateObject(*j));
+			}
+	}
+
+	// Build the occlusion mask in one pass, the whole level is being drawn anew so nothing needs redrawing
+	OcclusionDeferred = false;
+	for (auto i = Layers.begin(); i != Layers.end(); ++i)
+		if ((*i)->GetStoredType() == terra::Item::Tile)
+			for (auto j = (*i)->Begin(); j != (*i)->End(); ++j)
+				Occlusion.AddTile((*i)->GetDepth(), static_cast<const terra::Tile &>(**j));
+
+	// Objects already in view are there from the first frame
+	SpawnObjects();
+}
+
+void terra::Engine::BuildOcclusion(){
+	for (auto i = OgmoTilesets.begin(); i != OgmoTilesets.end(); ++i){
+		std::shared_ptr<sf::Image> Texture = GetTexture(i->second.Image);
+		if (Texture && Texture->GetWidth())
+			Occlusion.AddTileset(i->second.Image, *Texture, i->second.TileWidth, i->second.TileHeight, i->second.Animations);
+	}
+}
+
+void terra::Engine::BuildProject(const terra::ProjectData &Project){
+	// Settings, level values, and tilesets are used as they are
+	DefaultLevelValues = Project.LevelValues;
+	ValueTypes = Project.LevelValueTypes;
+	WorkingDirectory = Project.WorkingDirectory;
+	OgmoTilesets = Project.Tilesets;
+
+	// Tilesets' animations go into the animation table, however the project was read
+	for (auto i = Project.Tilesets.begin(); i != Project.Tilesets.end(); ++i)
+		for (auto j = i->second.Animations.begin(); j != i->second.Animations.end(); ++j)
+			TileAnimations.Add(i->second.Image, *j);
+
+	// Only objects the game has registered can be used, but compiled levels keep every object for whichever game loads them
+	for (auto i = Project.Objects.begin(); i != Project.Objects.end(); ++i){
+		if (!Compiling && Callbacks.find(i->first) == Callbacks.end()){
+			Warning(std::string("Object of name\"") + i->first + "\" hasn't been registered\n");
+			continue;
+		}
+		OgmoObjects[i->first] = i->second;
+	}
+
+	// Create the layers in drawing order
+	for (auto i = Project.Layers.begin(); i != Project.Layers.end(); ++i){
+		if (i->Type == terra::Item::Tile)
+			OgmoTileLayers[i->Name] = i->TileLayer;
+
+		// Grid layers have no items, only the cells kept by the engine
+		if (i->Type == terra::Item::Grid){
+			OgmoGridLayers[i->Name] = i->GridLayer;
+			Grids[i->Name] = terra::CollisionGrid();
+		}
+		std::shared_ptr<terra::Layer> NewLayer(new terra::Layer(i->Type, Layers.size()));
+		NamedLayers[i->Name] = NewLayer;
+		Layers.push_back(NewLayer);
+		LayerNames.push_back(i->Name);
+	}
+}
+
+void terra::Engine::BuildTilesetLODs(){
+	for (auto i = OgmoTilesets.begin(); i != OgmoTilesets.end(); ++i){
+		std::shared_ptr<sf::Image> Texture = GetTexture(i->second.Image);
+		if (Texture && Texture->GetWidth())
+			TileLODs.Add(i->second.Image, *Texture, i->second.TileWidth, i->second.TileHeight);
+	}
+}
+
+void terra::Engine::BuildTilesetPlans(){
+	// Work out each tileset's tile positions ahead of time, so the level parser never has to
+	TilesetPlans.clear();
+	for (auto i = OgmoTilesets.begin(); i != OgmoTilesets.end(); ++i){
+		terra::TilesetPlan &Plan = TilesetPlans[i->first];
+		std::shared_ptr<sf::Image> Texture = terra::GetTexture(i->second.Image);
+		Plan.Image = i->second.Image;
+		Plan.ImageSize = sf::Vector2<unsigned int>(Texture->GetWidth(), Texture->GetHeight());
+		Plan.TileSize = sf::Vector2<unsigned int>(i->second.TileWidth, i->second.TileHeight);
+		if (Plan.TileSize.x == 0 || Plan.TileSize.y == 0)
+			continue;
+
+		// Ids go left to right, then top to bottom
+		unsigned int Columns = Plan.ImageSize.x/Plan.TileSize.x;
+		unsigned int Rows = Plan.ImageSize.y/Plan.TileSize.y;
+		Plan.Positions.reserve(Columns*Rows);
+		for (unsigned int y = 0; y < Rows; ++y)
+			for (unsigned int x = 0; x < Columns; ++x)
+				Plan.Positions.push_back(sf::Vector2<unsigned int>(x*Plan.TileSize.x, y*Plan.TileSize.y));
+	}
+}
+
+int terra::Engine::CompileLevels(const int argc, char *argv[]){
+	if (argc < 2){
+		std::cerr << "Usage: " << argv[0] << " level.oel [level.oel ...]" << std::endl;
+		return 1;
+	}
+
+	// The project is needed to resolve tilesets, tile ids, and object definitions, registered or not, and is compiled as well
+	Compiling = true;
+	ParseProject();
+	int Result = 0;
+	for (auto i = ConsoleLog.begin(); i != ConsoleLog.end(); ++i)
+		if (i->first == 2)
+			Result = 1;
+	for (int i = 1; i < argc; ++i){
+		terra::LevelData Level;
+		std::string Problem;
+		std::string Filename = argv[i];
+		if (!ParseLevelFile(Filename, Level)){
+			Result = 1;
+			continue;
+		}
+		if (!terra::LevelFile::Write(terra::LevelFile::GetCompiledName(Filename), Level, Problem)){
+			Error(std::string("Unable to compile \"") + Filename + "\": " + Problem + "\n");
+			Result = 1;
+			continue;
+		}
+		Message(std::string("Compiled \"") + Filename + "\" to \"" + terra::LevelFile::GetCompiledName(Filename) + "\"\n");
+	}
+
+	// There's no console to show the log on, so print it
+	for (auto i = ConsoleLog.begin(); i != ConsoleLog.end(); ++i)
+		(i->first ? std::cerr : std::cout) << i->second;
+	return Result;
+}
+
+std::shared_ptr<terra::Item> terra::Engine::CreateObject(const terra::OgmoObject &Descriptor){
+	terra::OgmoObject NewObject = OgmoObjects[Descriptor.Name];
+	NewObject.Position = Descriptor.Position;
+	NewObject.Size = Descriptor.Size;
+	NewObject.Nodes = Descriptor.Nodes;
+	for (auto i = Descriptor.Values.begin(); i != Descriptor.Values.end(); ++i)
+		NewObject.Values[i->first] = i->second;
+	return Callbacks[Descriptor.Name](NewObject);
+}
+
+void terra::Engine::DrawStats(terra::RenderBackend &Backend, terra::ConsoleText &Overlay){
+	// Describe the whole frame, then each layer
+	std::list<std::pair<unsigned int, std::string>> Lines;
+	std::ostringstream Line;
+	Line << "Draw calls: " << Stats.DrawCalls << "  Texture binds: " << Stats.TextureBinds << "  Vertices: " << Stats.Vertices;
+	Lines.push_back(std::pair<unsigned int, std::string>(0, Line.str()));
+	for (auto i = LayerStats.begin(); i != LayerStats.end(); ++i){
+		Line.str("");
+		Line << i->first << ": " << i->second.Drawn << " drawn, " << i->second.Culled << " culled, " << i->second.DrawCalls << " draw calls";
+		Lines.push_back(std::pair<unsigned int, std::string>(0, Line.str()));
+	}
+
+	// Lay the lines out in the top left corner of the window, every frame since the numbers keep changing
+	sf::View Temp = Backend.GetView();
+	Backend.SetView(sf::View(sf::FloatRect(0, 0, Window.GetWidth(), Window.GetHeight())));
+	Overlay.Invalidate();
+	Overlay.Update(Lines, Window.GetWidth(), Lines.size()*terra::ConsoleText::LineHeight);
+	Overlay.Draw(Backend);
+	Backend.SetView(Temp);
 }
 
 void terra::Engine::Error(const std::string &ErrorMessage){
 	// Keep an error log, mark errors with id 2 for color-coding
+	std::lock_guard<std::mutex> Lock(LogGuard);
 	ConsoleLog.push_back(std::pair<unsigned int, std::string>(2, ErrorMessage));
 }
 
+const terra::TextureAtlas &terra::Engine::GetAtlas() const{
+	return Atlas;
+}
+
 terra::Engine &terra::Engine::Get(){
 	// Keeps a singleton (no use of new, C++0x requires proper initialization in multithreaded environments, iirc)
 	static terra::Engine Singleton;
 	return Singleton;
 }
 
+const terra::CollisionGrid *terra::Engine::GetGrid(const std::string &Name) const{
+	auto Found = Grids.find(Name);
+	return Found == Grids.end() ? nullptr : &Found->second;
+}
+
 std::shared_ptr<terra::Layer> terra::Engine::GetLayer(std::string Name){
 	// Give a null pointer if the layer doesn't exist
 	if (NamedLayers.find(Name) == NamedLayers.end())
@@ -51,6 +347,30 @@ std::string terra::Engine::GetLevelValueType(std::string Name){
 	return ValueTypes[Name];
 }
 
+const std::vector<std::pair<std::string, terra::RenderStats>> &terra::Engine::GetLayerRenderStats() const{
+	return LayerStats;
+}
+
+const terra::RenderStats &terra::Engine::GetRenderStats() const{
+	return Stats;
+}
+
+terra::SpriteBatch &terra::Engine::GetSpriteBatch(){
+	return Sprites;
+}
+
+const terra::TileAnimator &terra::Engine::GetTileAnimator() const{
+	return TileAnimations;
+}
+
+const terra::TileOcclusion &terra::Engine::GetTileOcclusion() const{
+	return Occlusion;
+}
+
+const terra::TilesetLOD &terra::Engine::GetTilesetLOD() const{
+	return TileLODs;
+}
+
 sf::RenderWindow &terra::Engine::GetWindow(){
 	return Window;
 }
@@ -60,6 +380,10 @@ void terra::Engine::Initialize(const int argc, char *argv[]){
 	unsigned int Width = 640, Height = 480, Framerate = 60;
 	std::string Title = "Terra Game Engine", InitialLevel = "res/levels/Title.oel";
 
+	// Resources are read from the pack when it is shipped, with loose files overriding it
+	if (terra::GetFileSize("res.pak") > 0)
+		terra::MountPack("res.pak");
+
 	// Parse the boot file
 	ParseBoot(Width, Height, Framerate, Title, InitialLevel);
 
@@ -70,18 +394,53 @@ void terra::Engine::Initialize(const int argc, char *argv[]){
 	NewLevel = true;
 	NextLevelName = InitialLevel;
 
-	// Parse the game's Ogmo Editor project to extract any needed info
+	// Parse the game's Ogmo Editor project to extract any needed info, then pack its images together and prepare its tilesets
 	ParseProject();
-
-	// Finish initialization
-	Window.Create(sf::VideoMode(Width, Height, 32), Title);
+	BuildAtlas();
+	BuildTilesetLODs();
+	BuildOcclusion();
+
+	// Finish initialization, rendering in memory instead of to a window when running headless
+	if (Headless){
+		Window.SetView(sf::View(sf::FloatRect(0, 0, Width, Height)));
+		Software = std::shared_ptr<terra::SoftwareRenderer>(new terra::SoftwareRenderer(Width, Height));
+	}
+	else
+		Window.Create(sf::VideoMode(Width, Height, 32), Title);
 	Initialized = true;
 }
 
+void terra::Engine::Invalidate(){
+	FullyDirty = true;
+}
+
+void terra::Engine::Invalidate(const sf::FloatRect &Area){
+	// Nobody's tracking
+	if (!DirtyRendering || FullyDirty || Area.Width <= 0. || Area.Height <= 0.)
+		return;
+
+	// Grow the dirty area to include the new area
+	if (!HasDirtyArea){
+		DirtyArea = Area;
+		HasDirtyArea = true;
+		return;
+	}
+	float Right = std::max(DirtyArea.Left+DirtyArea.Width, Area.Left+Area.Width);
+	float Bottom = std::max(DirtyArea.Top+DirtyArea.Height, Area.Top+Area.Height);
+	DirtyArea.Left = std::min(DirtyArea.Left, Area.Left);
+	DirtyArea.Top = std::min(DirtyArea.Top, Area.Top);
+	DirtyArea.Width = Right-DirtyArea.Left;
+	DirtyArea.Height = Bottom-DirtyArea.Top;
+}
+
 const bool terra::Engine::IsConsoleOpen() const{
 	return ConsoleOpen;
 }
 
+const bool terra::Engine::IsDirtyRendering() const{
+	return DirtyRendering;
+}
+
 void terra::Engine::LoadLevel(std::string Filename){
 	// Don't actually load the level, but prepare for loading at the beginning of the next frame
 	NewLevel = true;
@@ -95,28 +454,53 @@ int terra::Engine::Main(){
 		return -1;
 	}
 
+	// Run without a window if asked to
+	if (Headless)
+		return RunHeadless();
+
 	// Prepare the console
 	sf::Font ConsoleFont;
 	if (!ConsoleFont.LoadFromFile("res/fonts/DejaVuSansMono.ttf")){
 		Warning("Unable to locate the console font. Going with default Arial.");
 		ConsoleFont = sf::Font::GetDefaultFont();
 	}
+	terra::ConsoleText Console(ConsoleFont);
+	terra::ConsoleText StatsOverlay(ConsoleFont);
+	terra::TargetBackend WindowBackend(Window);
+	sf::RenderImage Snapshot;
+	sf::RenderImage BackBuffer;
+
+	// Hand drawing to the window over to a render thread if asked to
+	std::shared_ptr<terra::RenderThread> Renderer;
+	if (ThreadedRendering)
+		Renderer = std::shared_ptr<terra::RenderThread>(new terra::RenderThread(Window));
 
 	// Main Loop
+	sf::Clock FrameClock;
 	while (Window.IsOpened()){
 		// Main gameplay
 		if (!ConsoleOpen){
-			// Level loading
-			if (NewLevel)
+			// Level loading, once the render thread is done with the old level
+			if (NewLevel){
+				if (Renderer)
+					Renderer->Wait();
 				ParseLevel();
+			}
 
 			// Event handling
 			sf::Event Event;
 			while (Window.PollEvent(Event)){
-				if (Event.Type == sf::Event::Closed)
+				if (Event.Type == sf::Event::Closed){
+					if (Renderer)
+						Renderer->Wait();
 					Window.Close();
-				else if (Event.Type == sf::Event::KeyPressed && Event.Key.Code == sf::Key::Escape)
+				}
+				else if (Event.Type == sf::Event::KeyPressed && Event.Key.Code == sf::Key::Escape){
 					ConsoleOpen = true;
+					SnapshotTaken = false;
+				}
+				else if (Event.Type == sf::Event::KeyPressed && Event.Key.Code == sf::Key::F3)
+					ShowStats = !ShowStats;
 				else
 					for (auto i = Layers.begin(); i != Layers.end(); ++i)
 						for (auto j = (*i)->Begin(); j != (*i)->End(); ++j)
@@ -124,66 +508,90 @@ int terra::Engine::Main(){
 			}
 
 			// Game Logic
+			SpawnObjects();
 			for (auto i = Layers.begin(); i != Layers.end(); ++i)
 				for (auto j = (*i)->Begin(); j != (*i)->End(); ++j)
 					(*j)->OnFrame();
-
-			// Game Rendering
-			Window.Clear();
-			for (auto i = Layers.begin(); i != Layers.end(); ++i)
-				for (auto j = (*i)->Begin(); j != (*i)->End(); ++j)
-					(*j)->OnRender(Window);
-			Window.Display();
+			AnimateTiles(FrameClock.GetElapsedTime());
+			FrameClock.Reset();
+
+			// Game Rendering, recorded for the render thread to draw while the next frame runs
+			if (Renderer && !DirtyRendering){
+				terra::CommandList &Commands = Renderer->Begin();
+				Commands.Clear();
+				RenderLayers(Commands);
+				if (ShowStats)
+					DrawStats(Commands, StatsOverlay);
+
+				// Items drawing SFML drawables can only be seen if the window is drawn on this thread, so stop the render thread and drop the frame
+				if (Commands.GetIgnoredCount()){
+					Warning("Items drew SFML drawables, which the render thread can't record, so the window is drawn without it. Draw sprites and text through the engine's sprite batcher to use the render thread.\n");
+					Renderer.reset();
+					ThreadedRendering = false;
+				}
+				else
+					Renderer->Submit();
+			}
+			else{
+				if (Renderer)
+					Renderer->Wait();
+				if (DirtyRendering)
+					RenderDirty(BackBuffer);
+				else{
+					WindowBackend.Clear();
+					RenderLayers(WindowBackend);
+				}
+				if (ShowStats)
+					DrawStats(WindowBackend, StatsOverlay);
+				Window.Display();
+			}
 		}
 		// Console Control
 		else{
+			// The console draws to the window itself
+			if (Renderer)
+				Renderer->Wait();
+
 			// Event handling
 			sf::Event Event;
 			while (Window.PollEvent(Event)){
 				if (Event.Type == sf::Event::Closed)
 					Window.Close();
-				else if (Event.Type == sf::Event::KeyPressed && Event.Key.Code == sf::Key::Escape)
+				else if (Event.Type == sf::Event::KeyPressed && Event.Key.Code == sf::Key::Escape){
 					ConsoleOpen = false;
+					Console.ScrollToEnd();
+				}
+				else if (Event.Type == sf::Event::KeyPressed && Event.Key.Code == sf::Key::PageUp)
+					Console.Scroll(Window.GetHeight()/terra::ConsoleText::LineHeight/2);
+				else if (Event.Type == sf::Event::KeyPressed && Event.Key.Code == sf::Key::PageDown)
+					Console.Scroll(-static_cast<int>(Window.GetHeight()/terra::ConsoleText::LineHeight/2));
+				else if (Event.Type == sf::Event::KeyPressed && Event.Key.Code == sf::Key::End)
+					Console.ScrollToEnd();
+				else if (Event.Type == sf::Event::MouseWheelMoved)
+					Console.Scroll(Event.MouseWheel.Delta*3);
 			}
 
-			// Render the game's objects as if they were floating in the background
-			Window.Clear();
-			for (auto i = Layers.begin(); i != Layers.end(); ++i)
-				for (auto j = (*i)->Begin(); j != (*i)->End(); ++j)
-					(*j)->OnRender(Window);
-
-			// Darken the screen
+			// Render the game's objects once, then keep them frozen in the background until the console closes
+			if (!SnapshotTaken || Snapshot.GetWidth() != Window.GetWidth() || Snapshot.GetHeight() != Window.GetHeight())
+				TakeSnapshot(Snapshot);
 			sf::View Temp = Window.GetView();
 			sf::View Replacement(sf::FloatRect(0, 0, Window.GetWidth(), Window.GetHeight()));
 			Window.SetView(Replacement);
+			WindowBackend.Clear();
+			if (SnapshotTaken)
+				Window.Draw(sf::Sprite(Snapshot.GetImage()));
+			else{
+				Window.SetView(Temp);
+				RenderLayers(WindowBackend);
+				Window.SetView(Replacement);
+			}
+
+			// Darken the screen
 			Window.Draw(sf::Shape::Rectangle(0., 0., Window.GetWidth(), Window.GetHeight(), sf::Color(0, 0, 0, 170)));
 
-			// Draw the console output
-			unsigned int LineCounter = 0;
-			unsigned int LineMax = Window.GetHeight()/20;
-			for (auto i = ConsoleLog.rbegin(); i != ConsoleLog.rend(); ++i){
-				// End the console rendering if too many lines
-				if (LineCounter >= LineMax)
-					break;
-
-				// Prepare the text
-				unsigned int LineY = Window.GetHeight()-(LineCounter+1)*20;
-				sf::Text Line(i->second, ConsoleFont, 16);
-
-				// Color code warnings and errors
-				if (i->first == 1)
-					Line.SetColor(sf::Color::Yellow);
-				else if (i->first == 2)
-					Line.SetColor(sf::Color::Red);
-
-				// Set the positions
-				Line.SetX(2);
-				Line.SetY(LineY);
-
-				// And Render!
-				Window.Draw(Line);
-				++LineCounter;
-			}
+			// Draw the console output, which is only laid out again when something changed
+			Console.Update(ConsoleLog, Window.GetWidth(), Window.GetHeight());
+			Console.Draw(WindowBackend);
 			Window.Display();
 			Window.SetView(Temp);
 		}
@@ -192,14 +600,17 @@ int terra::Engine::Main(){
 }
 
 void terra::Engine::Message(const std::string &TheMessage){
+	std::lock_guard<std::mutex> Lock(LogGuard);
 	ConsoleLog.push_back(std::pair<unsigned int, std::string>(0, TheMessage));
 }
 
 void terra::Engine::ParseBoot(unsigned int &Width, unsigned int &Height, unsigned int &Framerate, std::string &Title, std::string &InitialLevel){
-	// Open up the Boot file and parse it with RapidXML
-	std::vector<char> Contents = terra::ReadFile("res/cfg/Boot.cfg");
+	// Open up the Boot file and parse it in place with RapidXML
+	terra::MappedFile Contents;
+	if (!terra::ReadFile("res/cfg/Boot.cfg", Contents))
+		return;
 	rapidxml::xml_document<> Boot;
-	Boot.parse<0>(&Contents[0]);
+	Boot.parse<0>(Contents.GetWritableData());
 
 	// Check for the root
 	rapidxml::xml_node<> *Root = Boot.first_node("config");
@@ -247,6 +658,12 @@ void terra::Engine::ParseCommandLine(const int argc, char *argv[], unsigned int
 
 	// Translate the commands into values
 	for (auto i = ArgumentList.begin(); i != ArgumentList.end(); ++i){
+		// Options that take a value need one after them
+		bool TakesValue = *i == "-width" || *i == "-height" || *i == "-frames" || *i == "-screenshot" || *i == "-benchmark" || *i == "-levelcache";
+		if (TakesValue && std::next(i) == ArgumentList.end()){
+			Warning(std::string("Command line option \"") + *i + "\" is missing its value\n");
+			break;
+		}
 		if (*i == "-width"){
 			int Temp = atoi((++i)->c_str());
 			Width = Temp > 0 ? Temp : Width;
@@ -255,48 +672,192 @@ void terra::Engine::ParseCommandLine(const int argc, char *argv[], unsigned int
 			int Temp = atoi((++i)->c_str());
 			Height = Temp > 0 ? Temp : Height;
 		}
+		else if (*i == "-headless")
+			Headless = true;
+		else if (*i == "-frames"){
+			int Temp = atoi((++i)->c_str());
+			HeadlessFrames = Temp > 0 ? Temp : HeadlessFrames;
+		}
+		else if (*i == "-screenshot")
+			ScreenshotFile = *(++i);
+		else if (*i == "-renderthread")
+			ThreadedRendering = true;
+		else if (*i == "-stats")
+			ShowStats = true;
+		else if (*i == "-benchmark")
+			BenchmarkFile = *(++i);
+		else if (*i == "-levelcache"){
+			int Temp = atoi((++i)->c_str());
+			if (Temp >= 0)
+				ParsedLevels.SetBudget(Temp*1024UL*1024UL);
+		}
 	}
 }
 
-void terra::Engine::ParseLayers(rapidxml::xml_node<> *Root){
+void terra::Engine::ParseGridLayer(rapidxml::xml_node<> *GridLayer, terra::ProjectData &Project){
+	// Validate the layer
+	if (GridLayer->first_attribute("name") == nullptr)
+		return;
+	std::string Name = GridLayer->first_attribute("name")->value();
+
+	// Ensure that the layer isn't a duplicate
+	if (HasLayer(Project, Name)){
+		Warning(std::string("Layer of name \"") + Name + "\" already exists\n");
+		return;
+	}
+
+	// Get the size of the cells, and the character that ends each row
+	terra::ProjectLayerData NewLayer;
+	NewLayer.Name = Name;
+	NewLayer.Type = terra::Item::Grid;
+	NewLayer.GridLayer.CellSize = sf::Vector2<unsigned int>(16, 16);
+	NewLayer.GridLayer.RowEnd = '\n';
+	if (GridLayer->first_attribute("gridSize") != nullptr){
+		int Temp = atoi(GridLayer->first_attribute("gridSize")->value());
+		if (Temp > 0)
+			NewLayer.GridLayer.CellSize = sf::Vector2<unsigned int>(Temp, Temp);
+	}
+	if (GridLayer->first_attribute("newLine") != nullptr && GridLayer->first_attribute("newLine")->value_size() > 0)
+		NewLayer.GridLayer.RowEnd = GridLayer->first_attribute("newLine")->value()[GridLayer->first_attribute("newLine")->value_size()-1];
+
+	// Store the new layer
+	Project.Layers.push_back(NewLayer);
+}
+
+void terra::Engine::ParseLayers(rapidxml::xml_node<> *Root, terra::ProjectData &Project){
 	for (auto Layers = Root->first_node("layers"); Layers != nullptr; Layers = Layers->next_sibling("layers")){
 		// Skip invalid layers
 		if (Layers->type() != rapidxml::node_element)
 			continue;
 
+		// Parse Grid Layers
+		for (auto LayerIterator = Layers->first_node("grid"); LayerIterator != nullptr; LayerIterator = LayerIterator->next_sibling("grid")){
+			if (LayerIterator->type() != rapidxml::node_element)
+				continue;
+			ParseGridLayer(LayerIterator, Project);
+		}
+
 		// Parse Tile Layers
 		for (auto LayerIterator = Layers->first_node("tiles"); LayerIterator != nullptr; LayerIterator = LayerIterator->next_sibling("tiles")){
 			if (LayerIterator->type() != rapidxml::node_element)
 				continue;
-			ParseTileLayer(LayerIterator);
+			ParseTileLayer(LayerIterator, Project);
 		}
 
 		// Parse Object Layers
 		for (auto LayerIterator = Layers->first_node("objects"); LayerIterator != nullptr; LayerIterator = LayerIterator->next_sibling("objects")){
 			if (LayerIterator->type() != rapidxml::node_element)
 				continue;
-			ParseObjectLayer(LayerIterator);
+			ParseObjectLayer(LayerIterator, Project);
 		}
 	}
 }
 
 void terra::Engine::ParseLevel(){
 	// Clear out the old level and tell the engine that the level has loaded (or at least tried to)
+	OcclusionDeferred = true;
 	for (auto i = Layers.begin(); i != Layers.end(); ++i)
 		(*i)->Clear();
+	Occlusion.Clear();
+	OcclusionDeferred = false;
+	for (auto i = Grids.begin(); i != Grids.end(); ++i)
+		i->second = terra::CollisionGrid();
+	Spawner.Clear();
+	Spawner.SetRadius(SpawnRadius, DespawnRadius);
 	LevelValues = DefaultLevelValues;
 	NewLevel = false;
 
-	// Read in the level file and parse it with RapidXML
-	std::vector<char> Contents = terra::ReadFile(NextLevelName);
-	rapidxml::xml_document<> Level;
-	Level.parse<0>(&Contents[0]);
+	// Levels that have been loaded before are built straight from the cache, as long as their file hasn't changed
+	uint64_t Hash;
+	bool Identified = ParsedLevels.GetBudget() != 0 && (ParsedLevels.Identify(NextLevelName, Hash) || ParsedLevels.Identify(terra::LevelFile::GetCompiledName(NextLevelName), Hash));
+	const terra::LevelData *Cached = Identified ? ParsedLevels.Find(Hash) : nullptr;
+	if (Cached != nullptr){
+		BuildLevel(*Cached);
+		return;
+	}
+
+	// Use the compiled level if it is newer than both the level and the project it was compiled against
+	terra::LevelData Level;
+	bool Loaded = false;
+	std::string Compiled = terra::LevelFile::GetCompiledName(NextLevelName);
+	std::time_t CompiledTime = terra::GetModificationTime(Compiled);
+	if (CompiledTime != 0){
+		std::string Problem;
+		if (CompiledTime < terra::GetModificationTime(terra::FindFile(NextLevelName)) || CompiledTime < terra::GetModificationTime("res/cfg/Levels.oep"))
+			Warning(std::string("Compiled level \"") + Compiled + "\" is out of date, loading the XML instead\n");
+		else if (!terra::LevelFile::Read(Compiled, Level, Problem)){
+			Warning(std::string("Compiled level \"") + Compiled + "\" can't be used (" + Problem + "), loading the XML instead\n");
+			Level = terra::LevelData();
+		}
+		else
+			Loaded = true;
+	}
+
+	// Packed compiled levels are used in place, unless a loose level overrides them
+	const terra::PackFile::Entry *Found;
+	const terra::PackFile *Pack;
+	if (CompiledTime == 0 && terra::GetModificationTime(terra::FindFile(NextLevelName)) == 0 && (Pack = terra::FindPacked(Compiled, Found)) != nullptr){
+		std::string Problem;
+		std::vector<char> Contents;
+		if (Found->Compressed && !Pack->Extract(*Found, Contents))
+			Problem = "it is damaged";
+		if (!Problem.empty() || !terra::LevelFile::Read(Found->Compressed ? &Contents[0] : Pack->GetData(*Found), Found->Size, Level, Problem)){
+			Warning(std::string("Packed compiled level \"") + Compiled + "\" can't be used (" + Problem + "), loading the XML instead\n");
+			Level = terra::LevelData();
+		}
+		else
+			Loaded = true;
+	}
+
+	// Otherwise parse the level itself
+	if (!Loaded && !ParseLevelFile(NextLevelName, Level))
+		return;
+	if (Identified)
+		Cached = ParsedLevels.Add(Hash, Level);
+	BuildLevel(Cached != nullptr ? *Cached : Level);
+}
+
+bool terra::Engine::ParseLevelFile(const std::string &Filename, terra::LevelData &Level){
+	// Compressed levels are inflated a chunk at a time straight into the streaming parser, without a decompressed copy ever being kept
+	std::string Found = terra::FindFile(Filename);
+	if (terra::IsCompressed(Found)){
+		std::ifstream Source(Found.c_str(), std::ios::binary);
+		if (!Source){
+			Error(std::string("Unable to open \"") + Found + "\"\n");
+			return false;
+		}
+		terra::InflateBuffer Inflater(Source);
+		std::istream Decompressed(&Inflater);
+		bool Parsed = ParseLevelStream(Decompressed, Found, Level);
+		if (Inflater.HasFailed()){
+			Error(std::string("Unable to decompress \"") + Found + "\": " + Inflater.GetError() + "\n");
+			return false;
+		}
+		return Parsed;
+	}
+
+	// Large levels are streamed instead, so they never have to be held in memory as a whole document
+	if (terra::GetFileSize(Filename) > StreamingSize){
+		std::ifstream Source(Filename.c_str(), std::ios::binary);
+		if (!Source){
+			Error(std::string("Unable to open \"") + Filename + "\"\n");
+			return false;
+		}
+		return ParseLevelStream(Source, Filename, Level);
+	}
+
+	// Map the level file and parse it in place with RapidXML
+	terra::MappedFile Contents;
+	if (!terra::ReadFile(Filename, Contents))
+		return false;
+	rapidxml::xml_document<> Document;
+	Document.parse<0>(Contents.GetWritableData());
 
 	// Check for the root node
-	rapidxml::xml_node<> *LevelRoot = Level.first_node("level");
+	rapidxml::xml_node<> *LevelRoot = Document.first_node("level");
 	if (LevelRoot == nullptr || LevelRoot->type() != rapidxml::node_element){
-		Error(std::string("Level file \"") + NextLevelName + "\" has no root node\n");
-		return;
+		Error(std::string("Level file \"") + Filename + "\" has no root node\n");
+		return false;
 	}
 
 	// Parse the level's values
@@ -306,196 +867,213 @@ void terra::Engine::ParseLevel(){
 		std::string Value = i->value();
 
 		// Validate that the value exists
-		if (LevelValues.find(Name) == LevelValues.end()){
+		if (DefaultLevelValues.find(Name) == DefaultLevelValues.end()){
 			Warning(std::string("Level value of name \"") + Name + "\" does not exist\n");
 			continue;
 		}
 
 		// Set the value
-		LevelValues[Name] = Value;
+		Level.Values[Name] = Value;
 	}
 
-	// Begin parsing the layers that were registered in the project file
+	// Find the layers that were registered in the project file
+	std::vector<std::pair<rapidxml::xml_node<> *, terra::Item::ItemType>> LayerNodes;
 	for (auto i = NamedLayers.begin(); i != NamedLayers.end(); ++i){
 		// Check if the layer exists
 		rapidxml::xml_node<> *LayerIterator = LevelRoot->first_node(i->first.c_str());
 		if (LayerIterator == nullptr || LayerIterator->type() != rapidxml::node_element)
 			continue;
+		LayerNodes.push_back(std::make_pair(LayerIterator, i->second->GetStoredType()));
+		Level.Layers.push_back(terra::LevelLayerData());
+		Level.Layers.back().Name = i->first;
+	}
 
-		// Parse the Tile Layers
-		if (i->second->GetStoredType() == terra::Item::Tile)
-			ParseLevelTileLayer(LayerIterator);
+	// The layers are independent, so each one is parsed on its own thread into its own slot of the level
+	terra::ThreadPool Pool(std::min<unsigned int>(LayerNodes.size(), terra::ThreadPool::GetHardwareThreads())-(LayerNodes.empty() ? 0 : 1));
+	for (unsigned int i = 0; i < LayerNodes.size(); ++i){
+		rapidxml::xml_node<> *Node = LayerNodes[i].first;
+		terra::LevelLayerData *Data = &Level.Layers[i];
+		if (LayerNodes[i].second == terra::Item::Tile)
+			Pool.Add([this, Node, Data](){ ParseLevelTileLayer(Node, *Data); });
+		if (LayerNodes[i].second == terra::Item::Object)
+			Pool.Add([this, Node, Data](){ ParseLevelObjectLayer(Node, *Data); });
+		if (LayerNodes[i].second == terra::Item::Grid)
+			Pool.Add([this, Node, Data](){ ParseLevelGridLayer(Node, *Data); });
+	}
+	Pool.Wait();
+	return true;
+}
 
-		// Parse the Object Layers
-		if (i->second->GetStoredType() == terra::Item::Object)
-			ParseLevelObjectLayer(LayerIterator);
+void terra::Engine::ParseLevelGridLayer(rapidxml::xml_node<> *GridLayer, terra::LevelLayerData &Data){
+	auto Definition = OgmoGridLayers.find(GridLayer->name());
+	if (Definition == OgmoGridLayers.end())
+		return;
+	terra::LevelLayerParser Parser(Data, nullptr, TilesetPlans, OgmoObjects);
+	Parser.BeginGrid(Definition->second);
+
+	// The cells are either the layer's text, or rectangles if the layer was exported as objects
+	for (auto i = GridLayer->first_node(); i != nullptr; i = i->next_sibling()){
+		if (i->type() == rapidxml::node_data || i->type() == rapidxml::node_cdata)
+			Parser.AddGridText(i->value(), i->value_size());
+		else if (i->type() == rapidxml::node_element && strcmp(i->name(), "rect") == 0){
+			rapidxml::xml_attribute<> *X = i->first_attribute("x");
+			rapidxml::xml_attribute<> *Y = i->first_attribute("y");
+			rapidxml::xml_attribute<> *Width = i->first_attribute("w");
+			rapidxml::xml_attribute<> *Height = i->first_attribute("h");
+			Parser.AddGridRect(X != nullptr ? X->value() : nullptr, Y != nullptr ? Y->value() : nullptr, Width != nullptr ? Width->value() : nullptr, Height != nullptr ? Height->value() : nullptr);
+		}
 	}
+	Parser.EndGrid();
 }
 
-void terra::Engine::ParseLevelObjectLayer(rapidxml::xml_node<> *ObjectLayer){
+void terra::Engine::ParseLevelObjectLayer(rapidxml::xml_node<> *ObjectLayer, terra::LevelLayerData &Data){
 	// Process each object in the layer
+	terra::LevelLayerParser Parser(Data, nullptr, TilesetPlans, OgmoObjects);
 	for (auto Object = ObjectLayer->first_node(); Object != nullptr; Object = Object->next_sibling()){
-		// Verify that the object is valid
-		if (Object->type() != rapidxml::node_element || Object->first_attribute("x") == nullptr || Object->first_attribute("y"))
-			continue;
-
-		// Verify that the object exists
-		if (OgmoObjects.find(Object->name()) == OgmoObjects.end()){
-			Warning(std::string("Object of name \"") + Object->name() + "\" does not exist\n");
+		if (Object->type() != rapidxml::node_element || !Parser.BeginObject(Object->name()))
 			continue;
-		}
-
-		// Parse the properties of the object
-		terra::OgmoObject NewObject;
-		NewObject.Name = Object->name();
-		NewObject.Position = sf::Vector2f(atof(Object->first_attribute("x")->value()), atof(Object->first_attribute("y")->value()));
-		if (NewObject.ResizableX && Object->first_attribute("width") != nullptr)
-			NewObject.Size.x = atoi(Object->first_attribute("width")->value());
-		if (NewObject.ResizableY && Object->first_attribute("height") != nullptr)
-			NewObject.Size.y = atoi(Object->first_attribute("height")->value());
 
-		// Parse the values of the object
-		for (auto i = Object->first_attribute(); i != nullptr; i = i->next_attribute()){
-			// Skip non-values
-			if (i->name() == "x" || i->name() == "y" || i->name() == "width" || i->name() == "height")
-				continue;
-
-			// Get the properties
-			std::string Name = i->name();
-			std::string Value = i->value();
-
-			// Verify that the value exists
-			if (NewObject.Values.find(Name) == NewObject.Values.end()){
-				Warning(std::string("Value of name \"") + Name + "\" does not exist\n");
-				continue;
-			}
-
-			// Update the value
-			NewObject.Values[Name] = Value;
-		}
+		// Parse the position, size, and values of the object
+		for (auto i = Object->first_attribute(); i != nullptr; i = i->next_attribute())
+			Parser.SetObjectAttribute(i->name(), i->value());
 
 		// Parse the object's nodes
-		for (auto i = Object->first_node("node"); i != nullptr; i = i->next_sibling("node")){
-			// Validate the node
-			if (i->type() != rapidxml::node_element || i->first_attribute("x") == nullptr || i->first_attribute("y") == nullptr)
-				continue;
-
-			// Add the node
-			NewObject.Nodes.push_back(sf::Vector2f(atof(i->first_attribute("x")->value()), atof(i->first_attribute("y")->value())));
-		}
-
-		// Validate that the object is registered
-		if (Callbacks.find(NewObject.Name) == Callbacks.end()){
-			Warning(std::string("Object of name\"") + NewObject.Name + "\" is not registered\n");
-			continue;
-		}
-
-		// Insert the object
-		NamedLayers[ObjectLayer->name()]->AddItem(Callbacks[NewObject.Name](NewObject));
+		for (auto i = Object->first_node("node"); i != nullptr; i = i->next_sibling("node"))
+			if (i->type() == rapidxml::node_element)
+				Parser.AddNode(i->first_attribute("x") != nullptr ? i->first_attribute("x")->value() : nullptr, i->first_attribute("y") != nullptr ? i->first_attribute("y")->value() : nullptr);
+		Parser.EndObject();
 	}
 }
 
-void terra::Engine::ParseLevelTileLayer(rapidxml::xml_node<> *TileLayer){
-	// Give up if the tileset is needed but not given
-	if (TileLayer->first_attribute("set") == nullptr && !OgmoTileLayers[TileLayer->name()].MultipleTilesets)
-		return;
-
-	// Prepare the tileset name (if needed)
-	std::string Set;
-	if (!OgmoTileLayers[TileLayer->name()].MultipleTilesets){
-		Set = TileLayer->first_attribute("set")->value();
-		if (OgmoTilesets.find(Set) == OgmoTilesets.end() || !GetTexture(Set))
-			return;
+bool terra::Engine::ParseLevelStream(std::istream &Source, const std::string &Filename, terra::LevelData &Level){
+	// Find the root node
+	terra::XMLReader Reader(Source);
+	terra::XMLReader::EventType Event;
+	while ((Event = Reader.Next()) == terra::XMLReader::Text);
+	if (Event != terra::XMLReader::StartElement || strcmp(Reader.GetName(), "level") != 0){
+		Error(std::string("Level file \"") + Filename + "\" has no root node\n");
+		return false;
 	}
 
-	// Read in the tile size (if needed)
-	unsigned int TileWidth;
-	unsigned int TileHeight;
-	if (OgmoTileLayers[TileLayer->name()].ExportTileSize){
-		if (TileLayer->first_attribute("tileWidth") == nullptr || TileLayer->first_attribute("tileHeight") == nullptr)
-			return;
-		TileWidth = atoi(TileLayer->first_attribute("tileWidth")->value());
-		TileHeight = atoi(TileLayer->first_attribute("tileHeight")->value());
-	}
-	else if (!OgmoTileLayers[TileLayer->name()].MultipleTilesets){
-		TileWidth = OgmoTilesets[Set].TileWidth;
-		TileHeight = OgmoTilesets[Set].TileHeight;
-	}
-
-	// And now we parse the tiles
-	for (auto TileIterator = TileLayer->first_node("tile"); TileIterator != nullptr; TileIterator = TileIterator->next_sibling("tile")){
-		// First check if the tile is valid
-		if (TileIterator->type() != rapidxml::node_element || TileIterator->first_attribute("x") == nullptr || TileIterator->first_attribute("y") == nullptr)
+	// Parse the level's values
+	for (unsigned int i = 0; i < Reader.GetAttributeCount(); ++i){
+		if (DefaultLevelValues.find(Reader.GetAttributeName(i)) == DefaultLevelValues.end()){
+			Warning(std::string("Level value of name \"") + Reader.GetAttributeName(i) + "\" does not exist\n");
 			continue;
+		}
+		Level.Values[Reader.GetAttributeName(i)] = Reader.GetAttributeValue(i);
+	}
 
-		// Now read in the position
-		sf::Vector2f Position = sf::Vector2f(atof(TileIterator->first_attribute("x")->value()), atof(TileIterator->first_attribute("y")->value()));
-		sf::Vector2<unsigned int> TilePosition;
+	// Every element is handled as it is read, with the parser of the layer it is in
+	std::shared_ptr<terra::LevelLayerParser> Parser;
+	std::set<std::string> Seen;
+	terra::Item::ItemType Type = terra::Item::Object;
+	while ((Event = Reader.Next()) != terra::XMLReader::End){
+		if (Event == terra::XMLReader::Error){
+			Error(std::string("Level file \"") + Filename + "\" is not valid XML: " + Reader.GetError() + "\n");
+			return false;
+		}
 
-		// Check if the needed information about tilesets is given or not (if needed)
-		if (OgmoTileLayers[TileLayer->name()].MultipleTilesets){
-			if (TileIterator->first_attribute("set") == nullptr)
-				continue;
-			Set = TileIterator->first_attribute("set")->value();
-			if (OgmoTilesets.find(Set) == OgmoTilesets.end() || !GetTexture(Set))
+		// Layers, only the first of each registered one is parsed
+		if (Event == terra::XMLReader::StartElement && Reader.GetDepth() == 2){
+			auto Found = NamedLayers.find(Reader.GetName());
+			if (Found == NamedLayers.end() || !Seen.insert(Reader.GetName()).second)
 				continue;
+			Level.Layers.push_back(terra::LevelLayerData());
+			Level.Layers.back().Name = Reader.GetName();
+			Type = Found->second->GetStoredType();
+			if (Type == terra::Item::Grid){
+				auto Definition = OgmoGridLayers.find(Reader.GetName());
+				Parser = std::shared_ptr<terra::LevelLayerParser>(new terra::LevelLayerParser(Level.Layers.back(), nullptr, TilesetPlans, OgmoObjects));
+				if (Definition != OgmoGridLayers.end())
+					Parser->BeginGrid(Definition->second);
+			}
+			else if (Type == terra::Item::Tile){
+				auto Definition = OgmoTileLayers.find(Reader.GetName());
+				Parser = std::shared_ptr<terra::LevelLayerParser>(new terra::LevelLayerParser(Level.Layers.back(), Definition != OgmoTileLayers.end() ? &Definition->second : nullptr, TilesetPlans, OgmoObjects));
+				if (!Parser->BeginTiles(Reader.GetAttribute("set"), Reader.GetAttribute("tileWidth"), Reader.GetAttribute("tileHeight")))
+					Parser.reset();
+			}
+			else
+				Parser = std::shared_ptr<terra::LevelLayerParser>(new terra::LevelLayerParser(Level.Layers.back(), nullptr, TilesetPlans, OgmoObjects));
+			continue;
 		}
-		if (!OgmoTileLayers[TileLayer->name()].ExportTileSize && OgmoTileLayers[TileLayer->name()].MultipleTilesets){
-			TileWidth = OgmoTilesets[Set].TileWidth;
-			TileHeight = OgmoTilesets[Set].TileHeight;
+		if (Event == terra::XMLReader::EndElement && Reader.GetDepth() == 1){
+			if (Parser && Type == terra::Item::Grid)
+				Parser->EndGrid();
+			Parser.reset();
+			continue;
 		}
+		if (!Parser)
+			continue;
 
-		// Parse the position of the tile in the tileset
-		if (OgmoTileLayers[TileLayer->name()].ExportTileIDs){
-			// Check if the tile id is given
-			if (TileIterator->first_attribute("id") == nullptr)
-				continue;
-
-			// Parse some information such as the id number and the size of each tile id
-			unsigned int ID = atoi(TileIterator->first_attribute("id")->value());
-			unsigned int IDWidth = (GetTexture(Set)->GetWidth()-GetTexture(Set)->GetWidth()%TileWidth)/TileWidth;
-			unsigned int IDHeight = (GetTexture(Set)->GetHeight()-GetTexture(Set)->GetHeight()%TileHeight)/TileHeight;
-
-			// Ensure that the id isn't too large
-			if (ID >= IDWidth*IDHeight)
-				continue;
+		// Grid cells, as text or rectangles
+		if (Type == terra::Item::Grid){
+			if (Event == terra::XMLReader::Text && Reader.GetDepth() == 2)
+				Parser->AddGridText(Reader.GetText().data(), Reader.GetText().size());
+			else if (Event == terra::XMLReader::StartElement && Reader.GetDepth() == 3 && strcmp(Reader.GetName(), "rect") == 0)
+				Parser->AddGridRect(Reader.GetAttribute("x"), Reader.GetAttribute("y"), Reader.GetAttribute("w"), Reader.GetAttribute("h"));
+			continue;
+		}
 
-			// Finally, calculate the tile position
-			TilePosition.x = ID%IDWidth*TileWidth;
-			TilePosition.y = (ID-ID%IDWidth)/IDWidth*TileHeight;
+		// Tiles
+		if (Type == terra::Item::Tile){
+			if (Event == terra::XMLReader::StartElement && Reader.GetDepth() == 3 && strcmp(Reader.GetName(), "tile") == 0){
+				terra::LevelLayerParser::TileAttributes Attributes;
+				for (unsigned int i = 0; i < Reader.GetAttributeCount(); ++i)
+					Attributes.Pick(Reader.GetAttributeName(i), Reader.GetAttributeValue(i));
+				Parser->AddTile(Attributes);
+			}
+			continue;
 		}
-		else{
-			// Check if the tile position is given
-			if (TileIterator->first_attribute("tx") == nullptr || TileIterator->first_attribute("ty") == nullptr)
-				continue;
 
-			// We don't have to do math here like we did with ided tiles. Yay
-			TilePosition.x = atoi(TileIterator->first_attribute("tx")->value());
-			TilePosition.y = atoi(TileIterator->first_attribute("ty")->value());
+		// Objects and their nodes
+		if (Event == terra::XMLReader::StartElement && Reader.GetDepth() == 3){
+			if (Parser->BeginObject(Reader.GetName()))
+				for (unsigned int i = 0; i < Reader.GetAttributeCount(); ++i)
+					Parser->SetObjectAttribute(Reader.GetAttributeName(i), Reader.GetAttributeValue(i));
 		}
+		else if (Event == terra::XMLReader::StartElement && Reader.GetDepth() == 4 && strcmp(Reader.GetName(), "node") == 0)
+			Parser->AddNode(Reader.GetAttribute("x"), Reader.GetAttribute("y"));
+		else if (Event == terra::XMLReader::EndElement && Reader.GetDepth() == 2)
+			Parser->EndObject();
+	}
+	return true;
+}
 
-		// Prepare the tile for insertion
-		terra::OgmoTile NextTile;
-		NextTile.Tileset = Set;
-		NextTile.TilePosition = TilePosition;
-		NextTile.TileSize = sf::Vector2<unsigned int>(TileWidth, TileHeight);
-		NextTile.Position = Position;
+void terra::Engine::ParseLevelTileLayer(rapidxml::xml_node<> *TileLayer, terra::LevelLayerData &Data){
+	// Layers are parsed in parallel, so everything shared is only looked up, never inserted into
+	auto Definition = OgmoTileLayers.find(TileLayer->name());
+	if (Definition == OgmoTileLayers.end())
+		return;
+	terra::LevelLayerParser Parser(Data, &Definition->second, TilesetPlans, OgmoObjects);
+	rapidxml::xml_attribute<> *Set = TileLayer->first_attribute("set");
+	rapidxml::xml_attribute<> *TileWidth = TileLayer->first_attribute("tileWidth");
+	rapidxml::xml_attribute<> *TileHeight = TileLayer->first_attribute("tileHeight");
+	if (!Parser.BeginTiles(Set != nullptr ? Set->value() : nullptr, TileWidth != nullptr ? TileWidth->value() : nullptr, TileHeight != nullptr ? TileHeight->value() : nullptr))
+		return;
 
-		// Insert the tile into the layer
-		NamedLayers[TileLayer->name()]->AddItem(std::shared_ptr<terra::Item>(new terra::Tile(NextTile)));
+	// And now we parse the tiles, picking out every attribute in a single pass
+	for (auto TileIterator = TileLayer->first_node("tile"); TileIterator != nullptr; TileIterator = TileIterator->next_sibling("tile")){
+		if (TileIterator->type() != rapidxml::node_element)
+			continue;
+		terra::LevelLayerParser::TileAttributes Attributes;
+		for (auto Attribute = TileIterator->first_attribute(); Attribute != nullptr; Attribute = Attribute->next_attribute())
+			Attributes.Pick(Attribute->name(), Attribute->value());
+		Parser.AddTile(Attributes);
 	}
 }
 
-void terra::Engine::ParseObjects(rapidxml::xml_node<> *Root){
+void terra::Engine::ParseObjects(rapidxml::xml_node<> *Root, terra::ProjectData &Project){
 	// Just a wrapper to parse all object folders
 	for (auto Folder = Root->first_node("objects"); Folder != nullptr; Folder = Folder->next_sibling("objects"))
-		ParseObjectFolder(Folder);
+		ParseObjectFolder(Folder, Project);
 }
 
-void terra::Engine::ParseObjectFolder(rapidxml::xml_node<> *Folder){
+void terra::Engine::ParseObjectFolder(rapidxml::xml_node<> *Folder, terra::ProjectData &Project){
 	// Parse all subfolders
 	for (auto NextFolder = Folder->first_node("folder"); NextFolder != nullptr; NextFolder = NextFolder->next_sibling("folder"))
-		ParseObjectFolder(NextFolder);
+		ParseObjectFolder(NextFolder, Project);
 
 	// Then parse all objects
 	for (auto Object = Folder->first_node("object"); Object != nullptr; Object = Object->next_sibling("object")){
@@ -515,6 +1093,8 @@ void terra::Engine::ParseObjectFolder(rapidxml::xml_node<> *Folder){
 			ResizableY = true;
 		NextObject.ResizableX = ResizableX;
 		NextObject.ResizableY = ResizableY;
+		if (Object->first_attribute("image") != nullptr)
+			NextObject.Image = Project.WorkingDirectory + Object->first_attribute("image")->value();
 
 		// Parse the default values
 		for (auto ValueContainer = Object->first_node("values"); ValueContainer != nullptr; ValueContainer = ValueContainer->next_sibling("values")){
@@ -545,23 +1125,17 @@ void terra::Engine::ParseObjectFolder(rapidxml::xml_node<> *Folder){
 		}
 
 		// Make sure the object isn't duplicated
-		if (OgmoObjects.find(NextObject.Name) != OgmoObjects.end()){
+		if (Project.Objects.find(NextObject.Name) != Project.Objects.end()){
 			Warning(std::string("Object of name \"") + NextObject.Name + "\" already exists\n");
 			continue;
 		}
 
-		// Make sure the object is registered
-		if (Callbacks.find(NextObject.Name) == Callbacks.end()){
-			Warning(std::string("Object of name\"") + NextObject.Name + "\" hasn't been registered\n");
-			continue;
-		}
-
-		// And insert
-		OgmoObjects[NextObject.Name] = NextObject;
+		// And insert, whether the object is registered is checked when the project is built
+		Project.Objects[NextObject.Name] = NextObject;
 	}
 }
 
-void terra::Engine::ParseObjectLayer(rapidxml::xml_node<> *ObjectLayer){
+void terra::Engine::ParseObjectLayer(rapidxml::xml_node<> *ObjectLayer, terra::ProjectData &Project){
 	// Verify that the layer is valid
 	if (ObjectLayer->first_attribute("name") == nullptr)
 		return;
@@ -570,67 +1144,191 @@ void terra::Engine::ParseObjectLayer(rapidxml::xml_node<> *ObjectLayer){
 	std::string Name = ObjectLayer->first_attribute("name")->value();
 
 	// Verify that the layer isn't a duplicate
-	if (NamedLayers.find(Name) != NamedLayers.end()){
+	if (HasLayer(Project, Name)){
 		Warning(std::string("Layer of name \"") + Name + "\" already exists\n");
 		return;
 	}
 
 	// Store the new layer
-	std::shared_ptr<terra::Layer> NewLayer(new terra::Layer(terra::Item::Object));
-	NamedLayers[Name] = NewLayer;
-	Layers.push_back(NewLayer);
+	terra::ProjectLayerData NewLayer;
+	NewLayer.Name = Name;
+	NewLayer.Type = terra::Item::Object;
+	Project.Layers.push_back(NewLayer);
 }
 
 void terra::Engine::ParseProject(){
-	// Read the project file in and parse it with RapidXML
-	std::vector<char> Contents = terra::ReadFile("res/cfg/Levels.oep");
-	rapidxml::xml_document<> Project;
-	Project.parse<0>(&Contents[0]);
+	// Map the project file, its hash tells whether the compiled project was made from it
+	terra::MappedFile Contents;
+	if (!terra::ReadFile("res/cfg/Levels.oep", Contents))
+		return;
+	uint64_t Hash = terra::HashData(Contents.GetData(), Contents.GetSize());
+
+	// Use the compiled project if there is one for this project file, loose or packed
+	terra::ProjectData Project;
+	std::string Compiled = terra::ProjectFile::GetCompiledName("res/cfg/Levels.oep");
+	std::string Problem;
+	terra::MappedFile CompiledContents;
+	const terra::PackFile::Entry *Found;
+	const terra::PackFile *Pack;
+	bool Loaded = false;
+	if (terra::GetModificationTime(Compiled) != 0)
+		Loaded = CompiledContents.Open(Compiled) && terra::ProjectFile::Read(CompiledContents.GetData(), CompiledContents.GetSize(), Hash, Project, Problem);
+	else if ((Pack = terra::FindPacked(Compiled, Found)) != nullptr){
+		std::vector<char> Extracted;
+		if (!Found->Compressed)
+			Loaded = terra::ProjectFile::Read(Pack->GetData(*Found), Found->Size, Hash, Project, Problem);
+		else if (Pack->Extract(*Found, Extracted))
+			Loaded = terra::ProjectFile::Read(&Extracted[0], Found->Size, Hash, Project, Problem);
+	}
 
-	// Get the project root
-	rapidxml::xml_node<> *ProjectRoot = Project.first_node("project");
+	// Tile animations were worked out from the size of each tileset's image, so the images can't have changed size either
+	for (auto i = Project.TilesetSizes.begin(); Loaded && i != Project.TilesetSizes.end(); ++i){
+		std::shared_ptr<sf::Image> Texture = GetTexture(i->first);
+		Loaded = Texture->GetWidth() == i->second.x && Texture->GetHeight() == i->second.y;
+		if (!Loaded)
+			Problem = "a tileset image has changed size";
+	}
+	if (!Loaded && !Compiling && Problem.size())
+		Warning(std::string("Compiled project \"") + Compiled + "\" can't be used (" + Problem + "), loading the XML instead\n");
 
-	// Make sure the project is valid
-	if (ProjectRoot == nullptr || ProjectRoot->type() != rapidxml::node_element){
-		Error("Project file \"res/cfg/Levels.oep\" has no root node\n");
-		return;
+	// Otherwise parse the project file in place with RapidXML
+	if (!Loaded){
+		Project = terra::ProjectData();
+		rapidxml::xml_document<> Document;
+		Document.parse<0>(Contents.GetWritableData());
+
+		// Get the project root
+		rapidxml::xml_node<> *ProjectRoot = Document.first_node("project");
+
+		// Make sure the project is valid
+		if (ProjectRoot == nullptr || ProjectRoot->type() != rapidxml::node_element){
+			Error("Project file \"res/cfg/Levels.oep\" has no root node\n");
+			return;
+		}
+
+		// Parse default values
+		for (auto ValueContainer = ProjectRoot->first_node("values"); ValueContainer != nullptr; ValueContainer = ValueContainer->next_sibling("values")){
+			// Verify that the value container is valid
+			if (ValueContainer->type() != rapidxml::node_element)
+				continue;
+
+			// Parse all values
+			for (auto Value = ValueContainer->first_node(); Value != nullptr; Value = Value->next_sibling()){
+				// Validate the value
+				if (Value->type() != rapidxml::node_element || (Value->name() != "boolean" && Value->name() != "integer" && Value->name() != "number" && Value->name() != "string" && Value->name() != "text") || Value->first_attribute("name") == nullptr || Value->first_attribute("default") == nullptr)
+					continue;
+
+				// Get the value's properties
+				std::string Name = Value->first_attribute("name")->value();
+				std::string Default = Value->first_attribute("default")->value();
+
+				// Validate that it isn't a duplicate
+				if (Project.LevelValues.find(Name) != Project.LevelValues.end()){
+					Warning(std::string("Level value of name \"") + Name + "\" already exists\n");
+					continue;
+				}
+
+				// Add the value to the default values
+				Project.LevelValues[Name] = Default;
+				Project.LevelValueTypes[Name] = Value->name();
+			}
+		}
+
+		// Parse everything
+		ParseSettings(ProjectRoot, Project);
+		ParseTilesets(ProjectRoot, Project);
+		ParseObjects(ProjectRoot, Project);
+		ParseLayers(ProjectRoot, Project);
+
+		// Only terra_levelc writes the compiled project, games may be installed somewhere they can't write to
+		if (Compiling){
+			if (terra::ProjectFile::Write(Compiled, Hash, Project, Problem))
+				Message(std::string("Compiled \"res/cfg/Levels.oep\" to \"") + Compiled + "\"\n");
+			else
+				Error(std::string("Unable to compile \"res/cfg/Levels.oep\": ") + Problem + "\n");
+		}
 	}
+	BuildProject(Project);
+	BuildTilesetPlans();
+}
 
-	// Parse default values
-	for (auto ValueContainer = ProjectRoot->first_node("values"); ValueContainer != nullptr; ValueContainer = ValueContainer->next_sibling("values")){
-		// Verify that the value container is valid
-		if (ValueContainer->type() != rapidxml::node_element)
+void terra::Engine::ParseSettings(rapidxml::xml_node<> *Root, terra::ProjectData &Project){
+	// Parse the working directory
+	Project.WorkingDirectory = "res/cfg/";
+	for (auto Settings = Root->first_node("settings"); Settings != nullptr; Settings = Settings->next_sibling("settings")){
+		// Validate the settings node
+		if (Settings->type() != rapidxml::node_element)
 			continue;
 
-		// Parse all values
-		for (auto Value = ValueContainer->first_node(); Value != nullptr; Value = Value->next_sibling()){
-			// Validate the value
-			if (Value->type() != rapidxml::node_element || (Value->name() != "boolean" && Value->name() != "integer" && Value->name() != "number" && Value->name() != "string" && Value->name() != "text") || Value->first_attribute("name") == nullptr || Value->first_attribute("default") == nullptr)
+		// Hunt for the working directory
+		bool Found = false;
+		for (auto WorkingDirectoryNode = Settings->first_node("workingDirectory"); WorkingDirectoryNode != nullptr; WorkingDirectoryNode = WorkingDirectoryNode->next_sibling("workingDirectory")){
+			// Validate the Working Directory Node
+			if (WorkingDirectoryNode->type() != rapidxml::node_element || WorkingDirectoryNode->first_node() == nullptr || WorkingDirectoryNode->first_node()->type() != rapidxml::node_data)
 				continue;
 
-			// Get the value's properties
-			std::string Name = Value->first_attribute("name")->value();
-			std::string Default = Value->first_attribute("default")->value();
+			// Update the working directory then evacuate
+			Project.WorkingDirectory += WorkingDirectoryNode->first_node()->value();
+			Found = true;
+			break;
+		}
+		if (Found)
+			break;
+	}
+}
+
+void terra::Engine::ParseTileAnimations(rapidxml::xml_node<> *Tileset, terra::OgmoTileset &NewTileset){
+	// Tile ids need the size of the tileset to be turned into positions
+	std::shared_ptr<sf::Image> Texture = GetTexture(NewTileset.Image);
+	unsigned int IDWidth = NewTileset.TileWidth ? Texture->GetWidth()/NewTileset.TileWidth : 0;
+	unsigned int IDHeight = NewTileset.TileHeight ? Texture->GetHeight()/NewTileset.TileHeight : 0;
 
-			// Validate that it isn't a duplicate
-			if (DefaultLevelValues.find(Name) != DefaultLevelValues.end()){
-				Warning(std::string("Level value of name \"") + Name + "\" already exists\n");
+	// Each animation is a list of frames, and the tile placed in the level is the first frame
+	for (auto i = Tileset->first_node("animation"); i != nullptr; i = i->next_sibling("animation")){
+		if (i->type() != rapidxml::node_element)
+			continue;
+		terra::TileAnimation NewAnimation;
+		NewAnimation.Length = 0.;
+		NewAnimation.Frame = 0;
+		for (auto j = i->first_node("frame"); j != nullptr; j = j->next_sibling("frame")){
+			// Validate the frame
+			if (j->type() != rapidxml::node_element || j->first_attribute("duration") == nullptr)
+				continue;
+			float Duration = atof(j->first_attribute("duration")->value());
+			if (Duration <= 0.)
 				continue;
+
+			// Frames are given by tile id or by position, like tiles in levels
+			sf::Vector2<unsigned int> Frame;
+			if (j->first_attribute("id") != nullptr){
+				unsigned int ID = atoi(j->first_attribute("id")->value());
+				if (ID >= IDWidth*IDHeight)
+					continue;
+				Frame.x = ID%IDWidth*NewTileset.TileWidth;
+				Frame.y = ID/IDWidth*NewTileset.TileHeight;
+			}
+			else if (j->first_attribute("tx") != nullptr && j->first_attribute("ty") != nullptr){
+				Frame.x = atoi(j->first_attribute("tx")->value());
+				Frame.y = atoi(j->first_attribute("ty")->value());
 			}
+			else
+				continue;
 
-			// Add the value to the default values
-			DefaultLevelValues[Name] = Default;
-			ValueTypes[Name] = Value->name();
+			NewAnimation.Frames.push_back(Frame);
+			NewAnimation.Durations.push_back(Duration);
+			NewAnimation.Length += Duration;
 		}
-	}
 
-	// Parse everything
-	ParseTilesets(ProjectRoot);
-	ParseObjects(ProjectRoot);
-	ParseLayers(ProjectRoot);
+		// Animations need at least two frames to be worth anything
+		if (NewAnimation.Frames.size() < 2){
+			Warning(std::string("Ignoring an animation with less than two frames in tileset \"") + NewTileset.Image + "\"\n");
+			continue;
+		}
+		NewTileset.Animations.push_back(NewAnimation);
+	}
 }
 
-void terra::Engine::ParseTileLayer(rapidxml::xml_node<> *TileLayer){
+void terra::Engine::ParseTileLayer(rapidxml::xml_node<> *TileLayer, terra::ProjectData &Project){
 	// Validate the layer
 	if (TileLayer->first_attribute("name") == nullptr)
 		return;
@@ -650,48 +1348,24 @@ void terra::Engine::ParseTileLayer(rapidxml::xml_node<> *TileLayer){
 		ExportTileIDs = true;
 
 	// Ensure that the layer isn't a duplicate
-	if (NamedLayers.find(Name) != NamedLayers.end()){
+	if (HasLayer(Project, Name)){
 		Warning(std::string("Layer of name \"") + Name + "\" already exists\n");
 		return;
 	}
 
 	// Prepare the new layer for storage
-	terra::OgmoTileLayer NewTileLayer;
-	NewTileLayer.MultipleTilesets = MultipleTilesets;
-	NewTileLayer.ExportTileSize = ExportTileSize;
-	NewTileLayer.ExportTileIDs = ExportTileIDs;
+	terra::ProjectLayerData NewLayer;
+	NewLayer.Name = Name;
+	NewLayer.Type = terra::Item::Tile;
+	NewLayer.TileLayer.MultipleTilesets = MultipleTilesets;
+	NewLayer.TileLayer.ExportTileSize = ExportTileSize;
+	NewLayer.TileLayer.ExportTileIDs = ExportTileIDs;
 
 	// Store the new layer
-	OgmoTileLayers[Name] = NewTileLayer;
-	std::shared_ptr<terra::Layer> NewLayer(new terra::Layer(terra::Item::Tile));
-	NamedLayers[Name] = NewLayer;
-	Layers.push_back(NewLayer);
+	Project.Layers.push_back(NewLayer);
 }
 
-void terra::Engine::ParseTilesets(rapidxml::xml_node<> *Root){
-	// Parse the working directory
-	std::string WorkingDirectory = "res/cfg/";
-	for (auto Settings = Root->first_node("settings"); Settings != nullptr; Settings = Settings->next_sibling("settings")){
-		// Validate the settings node
-		if (Settings->type() != rapidxml::node_element)
-			continue;
-
-		// Hunt for the working directory
-		bool Found = false;
-		for (auto WorkingDirectoryNode = Settings->first_node("workingDirectory"); WorkingDirectoryNode != nullptr; WorkingDirectoryNode = WorkingDirectoryNode->next_sibling("workingDirectory")){
-			// Validate the Working Directory Node
-			if (WorkingDirectoryNode->type() != rapidxml::node_element || WorkingDirectoryNode->first_node() == nullptr || WorkingDirectoryNode->first_node()->type() != rapidxml::node_data)
-				continue;
-
-			// Update the working directory then evacuate
-			WorkingDirectory += WorkingDirectoryNode->first_node()->value();
-			Found = true;
-			break;
-		}
-		if (Found)
-			break;
-	}
-
+void terra::Engine::ParseTilesets(rapidxml::xml_node<> *Root, terra::ProjectData &Project){
 	// Parse the tilesets
 	for (auto i = Root->first_node("tilesets"); i != nullptr; i = i->next_sibling("tilesets")){
 		// Validate the tileset container node
@@ -706,12 +1380,12 @@ void terra::Engine::ParseTilesets(rapidxml::xml_node<> *Root){
 
 			// Parse the values of the tileset
 			std::string TilesetName = j->first_attribute("name")->value();
-			std::string TilesetImage = WorkingDirectory + j->first_attribute("image")->value();
+			std::string TilesetImage = Project.WorkingDirectory + j->first_attribute("image")->value();
 			unsigned int TileWidth = atoi(j->first_attribute("tileWidth")->value());
 			unsigned int TileHeight = atoi(j->first_attribute("tileHeight")->value());
 
 			// Verify that the tileset isn't a duplicate
-			if (OgmoTilesets.find(TilesetName) != OgmoTilesets.end()){
+			if (Project.Tilesets.find(TilesetName) != Project.Tilesets.end()){
 				Warning(std::string("Tileset of name \"") + TilesetName + "\" already exists\n");
 				continue;
 			}
@@ -721,13 +1395,43 @@ void terra::Engine::ParseTilesets(rapidxml::xml_node<> *Root){
 			NewTileset.Image = TilesetImage;
 			NewTileset.TileWidth = TileWidth;
 			NewTileset.TileHeight = TileHeight;
+			ParseTileAnimations(j, NewTileset);
 
-			// Store the tileset
-			OgmoTilesets[TilesetName] = NewTileset;
+			// Store the tileset, along with the size of the image its animations were worked out from
+			std::shared_ptr<sf::Image> Texture = GetTexture(TilesetImage);
+			Project.Tilesets[TilesetName] = NewTileset;
+			Project.TilesetSizes[TilesetImage] = sf::Vector2<unsigned int>(Texture->GetWidth(), Texture->GetHeight());
 		}
 	}
 }
 
+void terra::Engine::RebuildOcclusion(terra::Layer &Source){
+	// Take the layer out of the mask, then put its tiles back where they are now
+	sf::FloatRect Changed = Occlusion.RemoveLayer(Source.GetDepth());
+	for (auto i = Source.Begin(); i != Source.End(); ++i){
+		if (!Occlusion.AddTile(Source.GetDepth(), static_cast<const terra::Tile &>(**i)))
+			continue;
+		sf::FloatRect Area((*i)->GetPosition(), sf::Vector2f((*i)->GetSize()));
+		if (Changed.Width <= 0. || Changed.Height <= 0.)
+			Changed = Area;
+		else{
+			float Right = std::max(Changed.Left+Changed.Width, Area.Left+Area.Width);
+			float Bottom = std::max(Changed.Top+Changed.Height, Area.Top+Area.Height);
+			Changed.Left = std::min(Changed.Left, Area.Left);
+			Changed.Top = std::min(Changed.Top, Area.Top);
+			Changed.Width = Right-Changed.Left;
+			Changed.Height = Bottom-Changed.Top;
+		}
+	}
+
+	// Then redraw whatever the change could have hidden or uncovered
+	if (Changed.Width <= 0. || Changed.Height <= 0.)
+		return;
+	for (auto i = Layers.begin(); i != Layers.end(); ++i)
+		if ((*i)->GetDepth() < Source.GetDepth() && (*i)->GetStoredType() == terra::Item::Tile)
+			(*i)->Invalidate(Changed);
+}
+
 void terra::Engine::RegisterObject(std::string Name, std::shared_ptr<terra::Item> (*Callback)(const terra::OgmoObject &)){
 	if (Callbacks.find(Name) != Callbacks.end()){
 		Warning(std::string("Object with name \"") + Name + "\" already registered\n");
@@ -736,9 +1440,232 @@ void terra::Engine::RegisterObject(std::string Name, std::shared_ptr<terra::Item
 	Callbacks.insert(std::pair<std::string, std::shared_ptr<terra::Item> (*)(const terra::OgmoObject &)>(Name, Callback));
 }
 
+void terra::Engine::RenderDirty(sf::RenderImage &BackBuffer){
+	// Redraw everything if the back buffer had to be made, or fall back to normal rendering if it can't be
+	if (BackBuffer.GetWidth() != Window.GetWidth() || BackBuffer.GetHeight() != Window.GetHeight()){
+		if (!sf::RenderImage::IsAvailable() || !BackBuffer.Create(Window.GetWidth(), Window.GetHeight())){
+			Warning("Unable to create the back buffer, dirty rendering has been disabled\n");
+			DirtyRendering = false;
+			terra::TargetBackend WindowBackend(Window);
+			WindowBackend.Clear();
+			RenderLayers(WindowBackend);
+			return;
+		}
+		FullyDirty = true;
+	}
+
+	// Moving the view moves everything
+	const sf::View &View = Window.GetView();
+	if (View.GetCenter() != LastView.GetCenter() || View.GetSize() != LastView.GetSize() || View.GetRotation() != LastView.GetRotation())
+		FullyDirty = true;
+	LastView = View;
+
+	// Redraw the whole game
+	terra::TargetBackend Backend(BackBuffer);
+	Stats = terra::RenderStats();
+	LayerStats.clear();
+	if (FullyDirty){
+		BackBuffer.SetView(View);
+		Backend.Clear();
+		RenderLayers(Backend);
+	}
+	// Or just the dirty area
+	else if (HasDirtyArea){
+		// Find the pixels covered by the dirty area, rounded out to whole pixels and clipped to the view's viewport
+		float BufferWidth = BackBuffer.GetWidth();
+		float BufferHeight = BackBuffer.GetHeight();
+		sf::FloatRect ViewRect = GetViewRect(View);
+		sf::FloatRect Viewport = View.GetViewport();
+		float ScaleX = Viewport.Width*BufferWidth/ViewRect.Width;
+		float ScaleY = Viewport.Height*BufferHeight/ViewRect.Height;
+		float OriginX = Viewport.Left*BufferWidth;
+		float OriginY = Viewport.Top*BufferHeight;
+		float Left = std::max(std::floor(OriginX+(DirtyArea.Left-ViewRect.Left)*ScaleX), std::ceil(OriginX));
+		float Top = std::max(std::floor(OriginY+(DirtyArea.Top-ViewRect.Top)*ScaleY), std::ceil(OriginY));
+		float Right = std::min(std::ceil(OriginX+(DirtyArea.Left+DirtyArea.Width-ViewRect.Left)*ScaleX), std::floor(OriginX+Viewport.Width*BufferWidth));
+		float Bottom = std::min(std::ceil(OriginY+(DirtyArea.Top+DirtyArea.Height-ViewRect.Top)*ScaleY), std::floor(OriginY+Viewport.Height*BufferHeight));
+
+		// Skip areas that can't be seen
+		if (Right > Left && Bottom > Top){
+			// Look at exactly those pixels
+			sf::FloatRect Area(ViewRect.Left+(Left-OriginX)/ScaleX, ViewRect.Top+(Top-OriginY)/ScaleY, (Right-Left)/ScaleX, (Bottom-Top)/ScaleY);
+			sf::View DirtyView(Area);
+			DirtyView.SetViewport(sf::FloatRect(Left/BufferWidth, Top/BufferHeight, (Right-Left)/BufferWidth, (Bottom-Top)/BufferHeight));
+			BackBuffer.SetView(DirtyView);
+
+			// Erase them, then draw whatever overlaps them
+			sf::Shape Eraser = sf::Shape::Rectangle(Area.Left, Area.Top, Area.Width, Area.Height, sf::Color::Black);
+			Eraser.SetBlendMode(sf::Blend::None);
+			BackBuffer.Draw(Eraser);
+			RenderLayers(Backend);
+		}
+	}
+	BackBuffer.Display();
+	FullyDirty = false;
+	HasDirtyArea = false;
+
+	// Copy the back buffer to the window
+	sf::View Temp = Window.GetView();
+	Window.SetView(sf::View(sf::FloatRect(0, 0, Window.GetWidth(), Window.GetHeight())));
+	Window.Draw(sf::Sprite(BackBuffer.GetImage()));
+	Window.SetView(Temp);
+}
+
+void terra::Engine::RenderLayers(terra::RenderBackend &Backend){
+	// Count each layer on its own, then add it to the frame's total
+	Stats = terra::RenderStats();
+	LayerStats.resize(Layers.size());
+	auto Name = LayerNames.begin();
+	auto Current = LayerStats.begin();
+	for (auto i = Layers.begin(); i != Layers.end(); ++i, ++Name, ++Current){
+		Current->first = *Name;
+		Current->second = terra::RenderStats();
+		Backend.SetStats(&Current->second);
+		(*i)->Render(Backend, Current->second);
+		Stats += Current->second;
+	}
+	Backend.SetStats(nullptr);
+}
+
+int terra::Engine::RunHeadless(){
+	// Run the game for a fixed number of frames, rasterizing every frame in memory
+	sf::Clock Timer;
+	terra::RenderStats Total;
+	std::vector<std::pair<std::string, terra::RenderStats>> LayerTotals;
+	unsigned int Frame;
+	for (Frame = 0; Frame < HeadlessFrames; ++Frame){
+		// Level loading
+		if (NewLevel)
+			ParseLevel();
+
+		// Game Logic, with time passing at a steady 60 frames per second
+		SpawnObjects();
+		for (auto i = Layers.begin(); i != Layers.end(); ++i)
+			for (auto j = (*i)->Begin(); j != (*i)->End(); ++j)
+				(*j)->OnFrame();
+		AnimateTiles(1./60.);
+
+		// Game Rendering
+		Software->SetView(Window.GetView());
+		Software->Clear();
+		RenderLayers(*Software);
+		Software->Display();
+
+		// Keep a running total of the render statistics
+		Total += Stats;
+		LayerTotals.resize(LayerStats.size());
+		for (unsigned int i = 0; i < LayerStats.size(); ++i){
+			LayerTotals[i].first = LayerStats[i].first;
+			LayerTotals[i].second += LayerStats[i].second;
+		}
+	}
+	float Elapsed = Timer.GetElapsedTime();
+
+	// Report how fast it went
+	std::cout << "Rendered " << Frame << " frames in software in " << Elapsed << " seconds";
+	if (Elapsed > 0.)
+		std::cout << " (" << Frame/Elapsed << " frames per second)";
+	std::cout << std::endl;
+
+	// Anything the software renderer left out is missing from every frame, which shouldn't pass for a correct run
+	if (Software->GetSkippedCount())
+		std::cerr << "Warning: " << Software->GetSkippedCount() << " draws were left out of the frames, the software renderer can only draw axis aligned quads and what items submit to the sprite batcher, not SFML drawables" << std::endl;
+
+	// Write the results out for comparing runs, if asked to
+	if (BenchmarkFile.size() && !WriteBenchmark(Frame, Elapsed, Total, LayerTotals)){
+		std::cerr << "Unable to write the benchmark results to \"" << BenchmarkFile << "\"" << std::endl;
+		return -1;
+	}
+
+	// Save the last frame if asked to
+	if (ScreenshotFile.size() && !Software->SaveToFile(ScreenshotFile)){
+		std::cerr << "Unable to save the screenshot to \"" << ScreenshotFile << "\"" << std::endl;
+		return -1;
+	}
+	return 0;
+}
+
+void terra::Engine::SetDirtyRendering(bool Enabled){
+	DirtyRendering = Enabled;
+	FullyDirty = true;
+	HasDirtyArea = false;
+}
+
+void terra::Engine::SetEagerObject(const std::string &Name, bool Eager){
+	if (Eager)
+		EagerObjects.insert(Name);
+	else
+		EagerObjects.erase(Name);
+}
+
+void terra::Engine::SetSpawnRadius(float Radius, float NewDespawnRadius){
+	SpawnRadius = Radius;
+	DespawnRadius = NewDespawnRadius;
+}
+
+void terra::Engine::SpawnObjects(){
+	Spawner.Update(terra::GetViewRect(Window.GetView()), [this](const terra::OgmoObject &Descriptor){
+		return CreateObject(Descriptor);
+	});
+}
+
+void terra::Engine::TakeSnapshot(sf::RenderImage &Snapshot){
+	// Give up on snapshots if the system can't render to images, the console will render the game every frame instead
+	SnapshotTaken = false;
+	if (!sf::RenderImage::IsAvailable())
+		return;
+	if ((Snapshot.GetWidth() != Window.GetWidth() || Snapshot.GetHeight() != Window.GetHeight()) && !Snapshot.Create(Window.GetWidth(), Window.GetHeight()))
+		return;
+
+	// Render the game into the snapshot through the game's view
+	terra::TargetBackend Backend(Snapshot);
+	Snapshot.SetView(Window.GetView());
+	Backend.Clear();
+	RenderLayers(Backend);
+	Snapshot.Display();
+	SnapshotTaken = true;
+}
+
+void terra::Engine::UpdateOcclusion(unsigned int Depth, const terra::Tile &Changed, bool Added){
+	// Loading and unloading levels rebuild the mask all at once
+	if (OcclusionDeferred)
+		return;
+	if (!(Added ? Occlusion.AddTile(Depth, Changed) : Occlusion.RemoveTile(Depth, Changed)))
+		return;
+
+	// Redraw the layers under the tile where it is
+	sf::FloatRect Area(Changed.GetPosition(), sf::Vector2f(Changed.GetSize()));
+	for (auto i = Layers.begin(); i != Layers.end(); ++i)
+		if ((*i)->GetDepth() < Depth && (*i)->GetStoredType() == terra::Item::Tile)
+			(*i)->Invalidate(Area);
+}
+
 void terra::Engine::Warning(const std::string &WarningMessage){
+	std::lock_guard<std::mutex> Lock(LogGuard);
 	ConsoleLog.push_back(std::pair<unsigned int, std::string>(1, WarningMessage));
 }
 
+bool terra::Engine::WriteBenchmark(unsigned int Frames, float Elapsed, const terra::RenderStats &Total, const std::vector<std::pair<std::string, terra::RenderStats>> &LayerTotals){
+	std::ofstream File(BenchmarkFile.c_str());
+	if (!File)
+		return false;
+
+	// Counters are averaged over every frame
+	float Divisor = Frames ? Frames : 1;
+	File << "{\n";
+	File << "\t\"frames\": " << Frames << ",\n";
+	File << "\t\"seconds\": " << Elapsed << ",\n";
+	File << "\t\"framesPerSecond\": " << (Elapsed > 0. ? Frames/Elapsed : 0.) << ",\n";
+	File << "\t\"perFrame\": {\"submitted\": " << Total.Submitted/Divisor << ", \"culled\": " << Total.Culled/Divisor << ", \"drawn\": " << Total.Drawn/Divisor << ", \"drawCalls\": " << Total.DrawCalls/Divisor << ", \"textureBinds\": " << Total.TextureBinds/Divisor << ", \"vertices\": " << Total.Vertices/Divisor << "},\n";
+	File << "\t\"layers\": [";
+	for (auto i = LayerTotals.begin(); i != LayerTotals.end(); ++i){
+		File << (i == LayerTotals.begin() ? "\n" : ",\n");
+		File << "\t\t{\"name\": \"" << EscapeJSON(i->first) << "\", \"submitted\": " << i->second.Submitted/Divisor << ", \"culled\": " << i->second.Culled/Divisor << ", \"drawn\": " << i->second.Drawn/Divisor << ", \"drawCalls\": " << i->second.DrawCalls/Divisor << ", \"textureBinds\": " << i->second.TextureBinds/Divisor << ", \"vertices\": " << i->second.Vertices/Divisor << "}";
+	}
+	File << "\n\t]\n";
+	File << "}\n";
+	return File.good();
+}
+
 terra::Engine::~Engine(){
 }
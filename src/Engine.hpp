@@ -1,17 +1,36 @@
 #ifndef TERRA_ENGINE_HPP
 #define TERRA_ENGINE_HPP
 
+#include <istream>
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <SFML/Graphics.hpp>
 #include <string>
+#include <vector>
+#include "CollisionGrid.hpp"
+#include "ConsoleText.hpp"
 #include "Layer.hpp"
+#include "LevelCache.hpp"
+#include "LevelData.hpp"
 #include "Object.hpp"
+#include "OgmoGridLayer.hpp"
 #include "OgmoObject.hpp"
 #include "OgmoTileLayer.hpp"
 #include "OgmoTileset.hpp"
+#include "ObjectSpawner.hpp"
+#include "ProjectData.hpp"
 #include "RapidXML.hpp"
+#include "RenderStats.hpp"
+#include "SoftwareRenderer.hpp"
+#include "SpriteBatch.hpp"
+#include "TextureAtlas.hpp"
+#include "TileAnimator.hpp"
+#include "TileOcclusion.hpp"
+#include "TilesetLOD.hpp"
+#include "TilesetPlan.hpp"
 
 namespace terra{
 	/*!
@@ -22,49 +41,120 @@ namespace terra{
 	class Engine{
 		private:
 			std::map<std::string, std::shared_ptr<Item> (*)(const OgmoObject &)> Callbacks;
+			TextureAtlas Atlas;
+			std::string BenchmarkFile;
+			bool Compiling;
 			std::list<std::pair<unsigned int, std::string>> ConsoleLog;
 			bool ConsoleOpen;
+			sf::FloatRect DirtyArea;
+			bool DirtyRendering;
+			bool FullyDirty;
+			bool HasDirtyArea;
+			bool Headless;
+			unsigned int HeadlessFrames;
 			bool Initialized;
+			sf::View LastView;
 			std::list<std::shared_ptr<Layer>> Layers;
+			std::vector<std::string> LayerNames;
+			std::vector<std::pair<std::string, RenderStats>> LayerStats;
+			std::mutex LogGuard;
 			std::map<std::string, std::shared_ptr<Layer>> NamedLayers;
 			bool NewLevel;
 			std::string NextLevelName;
+			bool OcclusionDeferred;
+			LevelCache ParsedLevels;
+			std::string ScreenshotFile;
+			bool ShowStats;
+			bool SnapshotTaken;
+			std::shared_ptr<SoftwareRenderer> Software;
+			SpriteBatch Sprites;
+			RenderStats Stats;
+			bool ThreadedRendering;
+			TileAnimator TileAnimations;
+			TilesetLOD TileLODs;
+			TileOcclusion Occlusion;
 			sf::RenderWindow Window;
 
 			// Ogmo Level Stuff
 			std::map<std::string, std::string> DefaultLevelValues;
+			std::map<std::string, CollisionGrid> Grids;
 			std::map<std::string, std::string> LevelValues;
 			std::map<std::string, std::string> ValueTypes;
+			std::string WorkingDirectory;
 
 			// Ogmo Tileset Stuff
+			std::map<std::string, OgmoGridLayer> OgmoGridLayers;
 			std::map<std::string, OgmoTileset> OgmoTilesets;
 			std::map<std::string, OgmoTileLayer> OgmoTileLayers;
+			std::map<std::string, TilesetPlan> TilesetPlans;
 
 			// Ogmo Object Stuff
+			float DespawnRadius;
+			std::set<std::string> EagerObjects;
 			std::map<std::string, OgmoObject> OgmoObjects;
+			ObjectSpawner Spawner;
+			float SpawnRadius;
+
+			// Resource Packing
+			void BuildAtlas();
+			void BuildOcclusion();
+			void BuildTilesetLODs();
+			void BuildTilesetPlans();
+
+			// Animation
+			void AnimateTiles(float Elapsed);
+
+			// Level Loading
+			void BuildLevel(const LevelData &Level);
+			void BuildProject(const ProjectData &Project);
+			std::shared_ptr<Item> CreateObject(const OgmoObject &Descriptor);
+			void SpawnObjects();
 
 			// Parsers
 			void ParseBoot(unsigned int &Width, unsigned int &Height, unsigned int &Framerate, std::string &Title, std::string &InitialLevel);
 			void ParseCommandLine(const int argc, char *argv[], unsigned int &Width, unsigned int &Height);
-			void ParseLayers(rapidxml::xml_node<> *Root);
+			void ParseGridLayer(rapidxml::xml_node<> *GridLayer, ProjectData &Project);
+			void ParseLayers(rapidxml::xml_node<> *Root, ProjectData &Project);
 			void ParseLevel();
-			void ParseLevelObjectLayer(rapidxml::xml_node<> *ObjectLayer);
-			void ParseLevelTileLayer(rapidxml::xml_node<> *TileLayer);
-			void ParseObjects(rapidxml::xml_node<> *Root);
-			void ParseObjectFolder(rapidxml::xml_node<> *Folder);
-			void ParseObjectLayer(rapidxml::xml_node<> *ObjectLayer);
+			bool ParseLevelFile(const std::string &Filename, LevelData &Level);
+			void ParseLevelGridLayer(rapidxml::xml_node<> *GridLayer, LevelLayerData &Data);
+			void ParseLevelObjectLayer(rapidxml::xml_node<> *ObjectLayer, LevelLayerData &Data);
+			bool ParseLevelStream(std::istream &Source, const std::string &Filename, LevelData &Level);
+			void ParseLevelTileLayer(rapidxml::xml_node<> *TileLayer, LevelLayerData &Data);
+			void ParseObjects(rapidxml::xml_node<> *Root, ProjectData &Project);
+			void ParseObjectFolder(rapidxml::xml_node<> *Folder, ProjectData &Project);
+			void ParseObjectLayer(rapidxml::xml_node<> *ObjectLayer, ProjectData &Project);
 			void ParseProject();
-			void ParseTileLayer(rapidxml::xml_node<> *TileLayer);
-			void ParseTilesets(rapidxml::xml_node<> *Root);
+			void ParseSettings(rapidxml::xml_node<> *Root, ProjectData &Project);
+			void ParseTileAnimations(rapidxml::xml_node<> *Tileset, OgmoTileset &NewTileset);
+			void ParseTileLayer(rapidxml::xml_node<> *TileLayer, ProjectData &Project);
+			void ParseTilesets(rapidxml::xml_node<> *Root, ProjectData &Project);
+
+			// Rendering
+			void DrawStats(RenderBackend &Backend, ConsoleText &Overlay);
+			void RenderDirty(sf::RenderImage &BackBuffer);
+			void RenderLayers(RenderBackend &Backend);
+			int RunHeadless();
+			bool WriteBenchmark(unsigned int Frames, float Elapsed, const RenderStats &Total, const std::vector<std::pair<std::string, RenderStats>> &LayerTotals);
+			void TakeSnapshot(sf::RenderImage &Snapshot);
 
 			Engine();
 			Engine(const Engine &Copy);
 			Engine &operator=(const Engine &Copy);
 		public:
+			/*!
+			 * \param argc The argc variable from main()
+			 * \param argv The argv variable from main()
+			 * \return 0 if every level was compiled, anything else means an error
+			 *
+			 * Compile every level named on the command line into the binary form read by ParseLevel, next to the level itself. The project file is parsed and compiled first, unless its compiled form is already up to date, but no window is created. Used by the terra_levelc tool.
+			 */
+			int CompileLevels(const int argc, char *argv[]);
+
 			/*!
 			 * \param ErrorMessage A message describing the error
 			 *
-			 * Sends an error to the console.
+			 * Sends an error to the console. Safe to call from any thread.
 			 */
 			void Error(const std::string &ErrorMessage);
 
@@ -75,6 +165,21 @@ namespace terra{
 			 */
 			static Engine &Get();
 
+			/*!
+			 * \return A reference to the engine's texture atlas
+			 *
+			 * Retrieve a reference to the texture atlas holding every tileset and object image of the project. Objects can draw their image from it with Find(GetImage()).
+			 */
+			const TextureAtlas &GetAtlas() const;
+
+			/*!
+			 * \param Name The name of the grid layer
+			 * \return The cells of the grid layer in the current level, or a null pointer if the project has no grid layer of that name
+			 *
+			 * Retrieve the solid cells of a grid layer, for checking points, areas, and lines against the level. The grid is replaced when the next level is loaded.
+			 */
+			const CollisionGrid *GetGrid(const std::string &Name) const;
+
 			/*!
 			 * \param Name The name of the layer to retrieve
 			 * \return A shared pointer to the layer with the given name
@@ -99,6 +204,48 @@ namespace terra{
 			 */
 			std::string GetLevelValueType(std::string Name);
 
+			/*!
+			 * \return The statistics of each layer during the last rendered frame, in drawing order
+			 *
+			 * Retrieve the name and render statistics of every layer during the last rendered frame.
+			 */
+			const std::vector<std::pair<std::string, RenderStats>> &GetLayerRenderStats() const;
+
+			/*!
+			 * \return The statistics of the last rendered frame
+			 *
+			 * Retrieve the counts of items that were submitted, culled, and drawn, and of the draw calls, texture binds, and vertices that were sent to the backend during the last rendered frame.
+			 */
+			const RenderStats &GetRenderStats() const;
+
+			/*!
+			 * \return A reference to the engine's sprite batcher
+			 *
+			 * Retrieve a reference to the sprite batcher. Objects can submit quads, sprites, and text to it in OnRender instead of drawing them onto the target, which works with every backend, and the engine draws every object's quads together once the object layer is done rendering.
+			 */
+			SpriteBatch &GetSpriteBatch();
+
+			/*!
+			 * \return A reference to the table of animated tiles
+			 *
+			 * Retrieve a reference to the table of tile animations declared by the project's tilesets, and the frame each of them is on.
+			 */
+			const TileAnimator &GetTileAnimator() const;
+
+			/*!
+			 * \return A reference to the occlusion mask
+			 *
+			 * Retrieve a reference to the mask of opaque tiles, which tile layers use to leave out tiles hidden by later layers.
+			 */
+			const TileOcclusion &GetTileOcclusion() const;
+
+			/*!
+			 * \return A reference to the downscaled tilesets
+			 *
+			 * Retrieve a reference to the downscaled copies of every tileset, which tile layers draw from when the view is zoomed out.
+			 */
+			const TilesetLOD &GetTilesetLOD() const;
+
 			/*!
 			 * \return A reference to the game window
 			 *
@@ -114,6 +261,18 @@ namespace terra{
 			 */
 			void Initialize(const int argc, char *argv[]);
 
+			/*!
+			 * Mark the whole screen as needing to be redrawn. Only used when dirty rendering is enabled.
+			 */
+			void Invalidate();
+
+			/*!
+			 * \param Area The area of the world that changed
+			 *
+			 * Mark an area of the world as needing to be redrawn. Only used when dirty rendering is enabled.
+			 */
+			void Invalidate(const sf::FloatRect &Area);
+
 			/*!
 			 * \return True if the console is open, false otherwise
 			 *
@@ -121,6 +280,13 @@ namespace terra{
 			 */
 			const bool IsConsoleOpen() const;
 
+			/*!
+			 * \return True if dirty rendering is enabled, false otherwise
+			 *
+			 * Determines if the engine only redraws areas of the screen that changed.
+			 */
+			const bool IsDirtyRendering() const;
+
 			/*!
 			 * \param Filename The filename of the level to be loaded
 			 *
@@ -138,10 +304,17 @@ namespace terra{
 			/*!
 			 * \param TheMessage A message
 			 *
-			 * Sends a message to the console.
+			 * Sends a message to the console. Safe to call from any thread.
 			 */
 			void Message(const std::string &TheMessage);
 
+			/*!
+			 * \param Source The layer whose tiles may have moved
+			 *
+			 * Take every tile of a layer out of the occlusion mask and put them back in, then redraw the layers under it wherever the mask changed. Called by Layer::Invalidate().
+			 */
+			void RebuildOcclusion(Layer &Source);
+
 			/*!
 			 * \param Name The name for the object used in the Ogmo Editor
 			 * \param Callback A callback function which creates a new shared pointer to the object
@@ -150,10 +323,42 @@ namespace terra{
 			 */
 			void RegisterObject(std::string Name, std::shared_ptr<Item> (*Callback)(const OgmoObject &));
 
+			/*!
+			 * \param Enabled Should dirty rendering be enabled?
+			 *
+			 * Enable or disable dirty rendering. With it enabled, the engine keeps the rendered game in an off-screen image and only redraws the part of it covering areas that were invalidated since the last frame. Items invalidate their old and new area when they are moved or resized, and should call Item::Invalidate() when their appearance changes. Useful for mostly static scenes.
+			 */
+			void SetDirtyRendering(bool Enabled);
+
+			/*!
+			 * \param Name The name of a registered object
+			 * \param Eager Should the object always be created when the level loads?
+			 *
+			 * Keep an object from waiting for the view to come near it, such as the player the view follows.
+			 */
+			void SetEagerObject(const std::string &Name, bool Eager = true);
+
+			/*!
+			 * \param Radius How far outside the view objects are created, or a negative number to create every object when the level loads
+			 * \param NewDespawnRadius How far outside the view created objects are dropped again, or 0 to keep them
+			 *
+			 * Create a level's objects only as the view comes near them, for large levels with many objects. Dropped objects are created afresh from the level when the view comes back, so anything they did is forgotten. Takes effect when the next level loads, and is off by default.
+			 */
+			void SetSpawnRadius(float Radius, float NewDespawnRadius = 0.);
+
+			/*!
+			 * \param Depth The depth of the tile's layer
+			 * \param Changed The tile that was added or removed
+			 * \param Added True if the tile was added, false if it was removed
+			 *
+			 * Update the occlusion mask for a single tile, and redraw the layers under it where the tile is if the mask changed. Called by layers as tiles are added and removed, and ignored while a level is being loaded or cleared, which rebuild the mask in one pass instead.
+			 */
+			void UpdateOcclusion(unsigned int Depth, const Tile &Changed, bool Added);
+
 			/*!
 			 * \param WarningMessage A message describing the warning
 			 *
-			 * Sends a warning to the console.
+			 * Sends a warning to the console. Safe to call from any thread.
 			 */
 			void Warning(const std::string &WarningMessage);
 
@@ -0,0 +1,86 @@
+#include <zlib.h>
+#include "InflateBuffer.hpp"
+
+terra::InflateBuffer::InflateBuffer(std::istream &NewSource, unsigned int BufferSize) : Source(NewSource){
+	Failed = false;
+	Finished = false;
+	Inflating = false;
+	Input.resize(BufferSize > 0 ? BufferSize : 1);
+	Output.resize(BufferSize > 0 ? BufferSize : 1);
+	setg(&Output[0], &Output[0], &Output[0]);
+
+	// Adding 32 to the window size detects gzip and zlib headers alike
+	Stream = new z_stream;
+	Stream->zalloc = Z_NULL;
+	Stream->zfree = Z_NULL;
+	Stream->opaque = Z_NULL;
+	Stream->next_in = Z_NULL;
+	Stream->avail_in = 0;
+	if (inflateInit2(Stream, 15+32) != Z_OK){
+		Failed = true;
+		Finished = true;
+		Problem = "unable to start decompressing";
+	}
+}
+
+const std::string &terra::InflateBuffer::GetError() const{
+	return Problem;
+}
+
+const bool terra::InflateBuffer::HasFailed() const{
+	return Failed;
+}
+
+std::streambuf::int_type terra::InflateBuffer::underflow(){
+	if (gptr() < egptr())
+		return traits_type::to_int_type(*gptr());
+
+	// Keep inflating until some output comes out, since a chunk of input can end up as nothing
+	while (!Finished){
+		// Read more compressed data once the last chunk is used up
+		if (Stream->avail_in == 0){
+			Source.read(&Input[0], Input.size());
+			Stream->next_in = reinterpret_cast<Bytef *>(&Input[0]);
+			Stream->avail_in = Source.gcount();
+			if (Stream->avail_in == 0){
+				Finished = true;
+				if (!Source.eof()){
+					Failed = true;
+					Problem = "unable to read the compressed data";
+				}
+				else if (Inflating){
+					Failed = true;
+					Problem = "the compressed data ends early";
+				}
+				break;
+			}
+		}
+
+		// Inflate as much as fits
+		Stream->next_out = reinterpret_cast<Bytef *>(&Output[0]);
+		Stream->avail_out = Output.size();
+		int Result = inflate(Stream, Z_NO_FLUSH);
+		Inflating = true;
+		if (Result == Z_STREAM_END){
+			// Another gzip member may follow this one
+			inflateReset(Stream);
+			Inflating = false;
+		}
+		else if (Result != Z_OK && Result != Z_BUF_ERROR){
+			Finished = true;
+			Failed = true;
+			Problem = Stream->msg != nullptr ? Stream->msg : "the compressed data is damaged";
+		}
+		size_t Produced = Output.size()-Stream->avail_out;
+		if (Produced > 0){
+			setg(&Output[0], &Output[0], &Output[0]+Produced);
+			return traits_type::to_int_type(*gptr());
+		}
+	}
+	return traits_type::eof();
+}
+
+terra::InflateBuffer::~InflateBuffer(){
+	inflateEnd(Stream);
+	delete Stream;
+}
@@ -0,0 +1,66 @@
+#ifndef TERRA_INFLATEBUFFER_HPP
+#define TERRA_INFLATEBUFFER_HPP
+
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+struct z_stream_s;
+
+namespace terra{
+	/*!
+	 * \brief Decompressing stream buffer
+	 *
+	 * A stream buffer which inflates gzip or zlib compressed data from another stream a chunk at a time, so an std::istream built on it can hand decompressed data to a parser without the whole thing ever being decompressed into memory. Concatenated gzip files are read one after the other.
+	 */
+	class InflateBuffer : public std::streambuf{
+		private:
+			bool Failed;
+			bool Finished;
+			bool Inflating;
+			std::vector<char> Input;
+			std::vector<char> Output;
+			std::string Problem;
+			std::istream &Source;
+			z_stream_s *Stream;
+			InflateBuffer(const InflateBuffer &Copy);
+			InflateBuffer &operator=(const InflateBuffer &Copy);
+		protected:
+			/*!
+			 * \return The next decompressed character, or the end of file
+			 *
+			 * Inflate the next chunk once the last one has been read.
+			 */
+			int_type underflow();
+		public:
+			/*!
+			 * \param NewSource The stream of compressed data, which must outlive the buffer
+			 * \param BufferSize The size of the chunks of compressed and decompressed data
+			 *
+			 * Create a new buffer at the start of a compressed stream.
+			 */
+			InflateBuffer(std::istream &NewSource, unsigned int BufferSize = 65536);
+
+			/*!
+			 * \return A description of what went wrong, if the data couldn't be decompressed
+			 *
+			 * Retrieve the reason the data couldn't be decompressed.
+			 */
+			const std::string &GetError() const;
+
+			/*!
+			 * \return True if the data couldn't be decompressed, false otherwise
+			 *
+			 * Determines if the stream ended because of an error rather than the end of the data.
+			 */
+			const bool HasFailed() const;
+
+			/*!
+			 * Finish decompressing.
+			 */
+			~InflateBuffer();
+	};
+}
+
+#endif
@@ -1,3 +1,4 @@
+#include "Engine.hpp"
 #include "Item.hpp"
 
 terra::Item::Item(sf::Vector2f InitialPosition, sf::Vector2<unsigned int> InitialSize){
@@ -13,12 +14,25 @@ const sf::Vector2<unsigned int> &terra::Item::GetSize() const{
 	return Size;
 }
 
+const bool terra::Item::IsCullable() const{
+	return true;
+}
+
+void terra::Item::Invalidate(){
+	terra::Engine::Get().Invalidate(sf::FloatRect(Position, sf::Vector2f(Size)));
+}
+
 void terra::Item::SetPosition(const sf::Vector2f &NewPosition){
+	// Both where the item was and where it is now need to be redrawn
+	Invalidate();
 	Position = NewPosition;
+	Invalidate();
 }
 
 void terra::Item::SetSize(const sf::Vector2<unsigned int> &NewSize){
+	Invalidate();
 	Size = NewSize;
+	Invalidate();
 }
 
 terra::Item::~Item(){
@@ -19,7 +19,8 @@ namespace terra{
 			 */
 			enum ItemType{
 				Tile,
-				Object
+				Object,
+				Grid
 			};
 
 			/*!
@@ -48,6 +49,18 @@ namespace terra{
 			 */
 			const sf::Vector2<unsigned int> &GetSize() const;
 
+			/*!
+			 * \return True if the item may be skipped when it is outside of the view, false otherwise
+			 *
+			 * Determines if the item can be culled. Override this to return false for items that draw outside of their position and size.
+			 */
+			virtual const bool IsCullable() const;
+
+			/*!
+			 * Mark the area covered by the item as needing to be redrawn. Call this when the item's appearance changes while dirty rendering is enabled.
+			 */
+			void Invalidate();
+
 			/*!
 			 * \param Event The event to be processed
 			 *
@@ -1,7 +1,15 @@
+#include <cmath>
+#include "Engine.hpp"
 #include "Layer.hpp"
+#include "Utilities.hpp"
 
-terra::Layer::Layer(terra::Item::ItemType StoredType){
+terra::Layer::Layer(terra::Item::ItemType StoredType, unsigned int NewDepth){
 	StoredItem = StoredType;
+	Depth = NewDepth;
+	BatchesDirty = true;
+	ChunksDirty = true;
+	Detail = 0;
+	Static = false;
 }
 
 void terra::Layer::AddItem(std::shared_ptr<Item> NewItem){
@@ -11,6 +19,30 @@ void terra::Layer::AddItem(std::shared_ptr<Item> NewItem){
 
 	// Then store it
 	Items.push_back(NewItem);
+	NewItem->Invalidate();
+	BatchesDirty = true;
+	if (GetStoredType() == terra::Item::Tile)
+		Engine::Get().UpdateOcclusion(Depth, static_cast<const terra::Tile &>(*NewItem), true);
+	if (Static && !ChunksDirty)
+		AddToChunks(NewItem);
+}
+
+void terra::Layer::AddToChunks(std::shared_ptr<terra::Item> NewItem){
+	// Find the range of chunks that the item overlaps
+	int Left = std::floor(NewItem->GetPosition().x/TileChunk::Size);
+	int Top = std::floor(NewItem->GetPosition().y/TileChunk::Size);
+	int Right = std::floor((NewItem->GetPosition().x+NewItem->GetSize().x-1)/TileChunk::Size);
+	int Bottom = std::floor((NewItem->GetPosition().y+NewItem->GetSize().y-1)/TileChunk::Size);
+
+	// Add the item to each of them, creating chunks as needed
+	for (int y = Top; y <= Bottom; ++y){
+		for (int x = Left; x <= Right; ++x){
+			std::shared_ptr<terra::TileChunk> &Chunk = Chunks[std::pair<int, int>(x, y)];
+			if (!Chunk)
+				Chunk.reset(new terra::TileChunk(sf::Vector2f(x*static_cast<float>(TileChunk::Size), y*static_cast<float>(TileChunk::Size)), Depth));
+			Chunk->AddTile(NewItem);
+		}
+	}
 }
 
 std::list<std::shared_ptr<terra::Item>>::iterator terra::Layer::Begin(){
@@ -18,19 +50,179 @@ std::list<std::shared_ptr<terra::Item>>::iterator terra::Layer::Begin(){
 }
 
 void terra::Layer::Clear(){
+	Engine::Get().Invalidate();
+	if (GetStoredType() == terra::Item::Tile)
+		for (auto i = Items.begin(); i != Items.end(); ++i)
+			Engine::Get().UpdateOcclusion(Depth, static_cast<const terra::Tile &>(**i), false);
 	Items.clear();
+	Chunks.clear();
+	BatchesDirty = true;
+	ChunksDirty = true;
 }
 
 std::list<std::shared_ptr<terra::Item>>::iterator terra::Layer::End(){
 	return Items.end();
 }
 
+const unsigned int terra::Layer::GetDepth() const{
+	return Depth;
+}
+
 const terra::Item::ItemType terra::Layer::GetStoredType() const{
 	return StoredItem;
 }
 
+void terra::Layer::Invalidate(){
+	Engine::Get().Invalidate();
+	BatchesDirty = true;
+	ChunksDirty = true;
+
+	// Tiles may have moved, so the layer's part of the occlusion mask is rebuilt
+	if (GetStoredType() == terra::Item::Tile)
+		Engine::Get().RebuildOcclusion(*this);
+}
+
+void terra::Layer::Invalidate(const sf::FloatRect &Area){
+	Engine::Get().Invalidate(Area);
+	BatchesDirty = true;
+
+	// Only redraw the chunks that overlap the area
+	for (auto i = Chunks.begin(); i != Chunks.end(); ++i)
+		if (i->second->GetBounds().Intersects(Area))
+			i->second->Invalidate();
+}
+
+const bool terra::Layer::IsStatic() const{
+	return Static;
+}
+
+void terra::Layer::RebuildBatches(){
+	// Sort the tiles into cells the size of a chunk by their top left corner, so whole cells can be culled
+	std::map<std::pair<int, int>, std::list<std::shared_ptr<terra::Item>>> Cells;
+	for (auto i = Items.begin(); i != Items.end(); ++i){
+		int x = std::floor((*i)->GetPosition().x/TileChunk::Size);
+		int y = std::floor((*i)->GetPosition().y/TileChunk::Size);
+		Cells[std::pair<int, int>(x, y)].push_back(*i);
+	}
+
+	// Cells that are left empty are dropped, the rest keep their batches' storage
+	for (auto i = Batches.begin(); i != Batches.end();){
+		if (Cells.find(i->first) == Cells.end())
+			Batches.erase(i++);
+		else
+			++i;
+	}
+	for (auto i = Cells.begin(); i != Cells.end(); ++i)
+		TileBatch::Build(i->second, Batches[i->first], Engine::Get().GetAtlas(), Engine::Get().GetTileAnimator(), Engine::Get().GetTilesetLOD(), Detail, &Engine::Get().GetTileOcclusion(), Depth);
+	BatchesDirty = false;
+}
+
+void terra::Layer::RebuildChunks(){
+	// Throw out the old chunks and sort every tile into new ones
+	Chunks.clear();
+	for (auto i = Items.begin(); i != Items.end(); ++i)
+		AddToChunks(*i);
+	ChunksDirty = false;
+}
+
+void terra::Layer::RemoveFromChunks(const std::shared_ptr<terra::Item> &OldItem){
+	// Remove the item from every chunk it was in, and drop chunks that are left empty
+	for (auto i = Chunks.begin(); i != Chunks.end();){
+		if (i->second->GetBounds().Intersects(sf::FloatRect(OldItem->GetPosition(), sf::Vector2f(OldItem->GetSize())))){
+			i->second->RemoveTile(OldItem);
+			if (i->second->IsEmpty()){
+				Chunks.erase(i++);
+				continue;
+			}
+		}
+		++i;
+	}
+}
+
 void terra::Layer::RemoveItem(std::list<std::shared_ptr<Item>>::iterator ItemIterator){
+	if (Static && !ChunksDirty)
+		RemoveFromChunks(*ItemIterator);
+	(*ItemIterator)->Invalidate();
+	if (GetStoredType() == terra::Item::Tile)
+		Engine::Get().UpdateOcclusion(Depth, static_cast<const terra::Tile &>(**ItemIterator), false);
 	Items.erase(ItemIterator);
+	BatchesDirty = true;
+}
+
+void terra::Layer::Render(terra::RenderBackend &Backend, terra::RenderStats &Stats){
+	// Grid layers only hold the cells of the level's grid, which the engine keeps
+	if (GetStoredType() == terra::Item::Grid)
+		return;
+	sf::FloatRect ViewRect = GetViewRect(Backend.GetView());
+
+	// Objects draw themselves, unless they're out of sight
+	if (GetStoredType() != terra::Item::Tile){
+		for (auto i = Items.begin(); i != Items.end(); ++i){
+			++Stats.Submitted;
+			if ((*i)->IsCullable() && !ViewRect.Intersects(sf::FloatRect((*i)->GetPosition(), sf::Vector2f((*i)->GetSize())))){
+				++Stats.Culled;
+				continue;
+			}
+			(*i)->OnRender(Backend.GetTarget());
+			++Stats.Drawn;
+		}
+
+		// Then draw everything the objects submitted to the sprite batcher together
+		Engine::Get().GetSpriteBatch().Flush(Backend);
+		return;
+	}
+
+	// Pick how detailed the tiles need to be from how many pixels each unit of the world covers
+	const sf::View &View = Backend.GetView();
+	unsigned int Level = TilesetLOD::ChooseLevel(Backend.GetTarget().GetWidth()*View.GetViewport().Width/View.GetSize().x);
+
+	// Static tiles are drawn from the chunks that can be seen
+	if (Static){
+		if (ChunksDirty)
+			RebuildChunks();
+		for (auto i = Chunks.begin(); i != Chunks.end(); ++i){
+			Stats.Submitted += i->second->GetTileCount();
+			if (!i->second->GetBounds().Intersects(ViewRect)){
+				Stats.Culled += i->second->GetTileCount();
+				continue;
+			}
+			i->second->Render(Backend, Level);
+			Stats.Drawn += i->second->GetTileCount();
+		}
+		return;
+	}
+
+	// Other tiles are drawn a cell and tileset at a time, skipping batches that are entirely out of sight
+	if (Level != Detail){
+		Detail = Level;
+		BatchesDirty = true;
+	}
+	if (BatchesDirty)
+		RebuildBatches();
+	for (auto i = Batches.begin(); i != Batches.end(); ++i)
+		for (auto j = i->second.begin(); j != i->second.end(); ++j){
+			if (!j->second->GetVertexCount())
+				continue;
+			Stats.Submitted += j->second->GetTileCount();
+			if (!j->second->GetBounds().Intersects(ViewRect)){
+				Stats.Culled += j->second->GetTileCount();
+				continue;
+			}
+			j->second->Animate(Engine::Get().GetTileAnimator());
+			j->second->Draw(Backend);
+			Stats.Drawn += j->second->GetTileCount();
+		}
+}
+
+void terra::Layer::SetStatic(bool NewStatic){
+	// Only tile layers can be cached
+	if (GetStoredType() != terra::Item::Tile || NewStatic == Static)
+		return;
+
+	// Chunks are rebuilt from scratch when they are next needed, and freed when they're not
+	Static = NewStatic;
+	Chunks.clear();
+	ChunksDirty = true;
 }
 
 terra::Layer::~Layer(){
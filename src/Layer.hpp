@@ -2,8 +2,15 @@
 #define TERRA_LAYER_HPP
 
 #include <list>
+#include <map>
 #include <memory>
+#include <string>
+#include <utility>
 #include "Item.hpp"
+#include "RenderBackend.hpp"
+#include "RenderStats.hpp"
+#include "TileBatch.hpp"
+#include "TileChunk.hpp"
 
 namespace terra{
 	/*!
@@ -15,13 +22,25 @@ namespace terra{
 		private:
 			std::list<std::shared_ptr<Item>> Items;
 			Item::ItemType StoredItem;
+			std::map<std::pair<int, int>, std::map<const sf::Image *, std::shared_ptr<TileBatch>>> Batches;
+			bool BatchesDirty;
+			std::map<std::pair<int, int>, std::shared_ptr<TileChunk>> Chunks;
+			bool ChunksDirty;
+			unsigned int Depth;
+			unsigned int Detail;
+			bool Static;
+			void AddToChunks(std::shared_ptr<Item> NewItem);
+			void RebuildBatches();
+			void RebuildChunks();
+			void RemoveFromChunks(const std::shared_ptr<Item> &OldItem);
 		public:
 			/*!
 			 * \param StoredType The type of item that will be stored in the layer
+			 * \param NewDepth The position of the layer in drawing order, counting up from the first layer drawn
 			 *
 			 * Create a new layer.
 			 */
-			Layer(Item::ItemType StoredType);
+			Layer(Item::ItemType StoredType, unsigned int NewDepth = 0);
 
 			/*!
 			 * \param NewItem A shared pointer to the item to add
@@ -49,6 +68,13 @@ namespace terra{
 			 */
 			std::list<std::shared_ptr<Item>>::iterator End();
 
+			/*!
+			 * \return The position of the layer in drawing order
+			 *
+			 * Retrieve the position of the layer in drawing order, where the first layer drawn is 0.
+			 */
+			const unsigned int GetDepth() const;
+
 			/*!
 			 * \return The type of item stored in the layer
 			 *
@@ -56,6 +82,25 @@ namespace terra{
 			 */
 			const Item::ItemType GetStoredType() const;
 
+			/*!
+			 * Mark the layer's batched geometry as outdated. Call this after moving a tile that is already in the layer. The layer's tiles are also put back into the occlusion mask.
+			 */
+			void Invalidate();
+
+			/*!
+			 * \param Area The area of the world that changed
+			 *
+			 * Mark the layer's batched geometry as outdated within an area. Static layers only redraw the chunks that overlap it, so use this for tiles that changed in place; tiles that move should be removed and added again.
+			 */
+			void Invalidate(const sf::FloatRect &Area);
+
+			/*!
+			 * \return True if the layer is static, false otherwise
+			 *
+			 * Check if the layer's tiles are cached in chunks.
+			 */
+			const bool IsStatic() const;
+
 			/*!
 			 * \param ItemIterator An iterator to the item to be removed
 			 *
@@ -63,6 +108,21 @@ namespace terra{
 			 */
 			void RemoveItem(std::list<std::shared_ptr<Item>>::iterator ItemIterator);
 
+			/*!
+			 * \param Backend The backend to be rendered to
+			 * \param Stats The statistics to add this layer's counts to
+			 *
+			 * Render every item in the layer that can be seen through the backend's view onto the backend. Tile layers are drawn with one batch per texture in each chunk sized cell of the world, so cells out of sight are skipped.
+			 */
+			void Render(RenderBackend &Backend, RenderStats &Stats);
+
+			/*!
+			 * \param NewStatic Should the layer be static?
+			 *
+			 * Set whether the layer is static. A static tile layer draws its tiles into cached chunk images once, and then only redraws the chunks whose tiles change. Has no effect on object layers.
+			 */
+			void SetStatic(bool NewStatic);
+
 			/*!
 			 * Destroy the layer.
 			 */
@@ -0,0 +1,125 @@
+#include "LevelCache.hpp"
+#include "MappedFile.hpp"
+#include "PackFile.hpp"
+#include "Utilities.hpp"
+
+namespace{
+	// A rough count of the memory held by a level, including what the standard containers spend on each element
+	const unsigned long NodeOverhead = 4*sizeof(void *);
+
+	unsigned long EstimateSize(const std::map<std::string, std::string> &Values){
+		unsigned long Size = 0;
+		for (auto i = Values.begin(); i != Values.end(); ++i)
+			Size += NodeOverhead+sizeof(*i)+i->first.capacity()+i->second.capacity();
+		return Size;
+	}
+
+	unsigned long EstimateSize(const terra::LevelData &Level){
+		unsigned long Size = sizeof(Level)+EstimateSize(Level.Values);
+		for (auto i = Level.Layers.begin(); i != Level.Layers.end(); ++i){
+			Size += sizeof(*i)+i->Name.capacity()+i->Tiles.capacity()*sizeof(terra::OgmoTile)+i->Objects.capacity()*sizeof(terra::OgmoObject)+i->Grid.GetWords().capacity()*sizeof(uint64_t);
+			for (auto j = i->Tiles.begin(); j != i->Tiles.end(); ++j)
+				Size += j->Tileset.capacity();
+			for (auto j = i->Objects.begin(); j != i->Objects.end(); ++j)
+				Size += j->Name.capacity()+j->Image.capacity()+EstimateSize(j->Values)+EstimateSize(j->ValueTypes)+j->Nodes.capacity()*sizeof(sf::Vector2f);
+		}
+		return Size;
+	}
+}
+
+terra::LevelCache::LevelCache(unsigned long NewBudget){
+	Budget = NewBudget;
+	Used = 0;
+}
+
+const terra::LevelData *terra::LevelCache::Add(uint64_t Hash, terra::LevelData &Level){
+	// Replace any older copy
+	auto Found = Levels.find(Hash);
+	if (Found != Levels.end()){
+		Used -= Found->second.Size;
+		Uses.erase(Found->second.Use);
+		Levels.erase(Found);
+	}
+
+	// Make room for the level, unless it wouldn't fit even in an empty cache
+	unsigned long Size = EstimateSize(Level);
+	if (Size > Budget)
+		return nullptr;
+	Trim(Budget-Size);
+	CachedLevel &Cached = Levels[Hash];
+	Cached.Level.Values.swap(Level.Values);
+	Cached.Level.Layers.swap(Level.Layers);
+	Cached.Size = Size;
+	Cached.Use = Uses.insert(Uses.end(), Hash);
+	Used += Size;
+	return &Cached.Level;
+}
+
+void terra::LevelCache::Clear(){
+	Levels.clear();
+	Sources.clear();
+	Used = 0;
+	Uses.clear();
+}
+
+const terra::LevelData *terra::LevelCache::Find(uint64_t Hash){
+	auto Found = Levels.find(Hash);
+	if (Found == Levels.end())
+		return nullptr;
+	Uses.splice(Uses.end(), Uses, Found->second.Use);
+	return &Found->second.Level;
+}
+
+const unsigned long terra::LevelCache::GetBudget(){
+	return Budget;
+}
+
+const unsigned long terra::LevelCache::GetUsed(){
+	return Used;
+}
+
+bool terra::LevelCache::Identify(const std::string &Filename, uint64_t &Hash){
+	// Loose files are only hashed again when their size or modification time changes
+	std::string Name = terra::FindFile(Filename);
+	std::time_t ModificationTime = terra::GetModificationTime(Name);
+	if (ModificationTime != 0){
+		unsigned long Size = terra::GetFileSize(Name);
+		auto Found = Sources.find(Name);
+		if (Found != Sources.end() && Found->second.ModificationTime == ModificationTime && Found->second.Size == Size){
+			Hash = Found->second.Hash;
+			return true;
+		}
+		terra::MappedFile Contents;
+		if (!Contents.Open(Name))
+			return false;
+		Hash = terra::HashData(Contents.GetData(), Contents.GetSize());
+		Source &Remembered = Sources[Name];
+		Remembered.Hash = Hash;
+		Remembered.ModificationTime = ModificationTime;
+		Remembered.Size = Size;
+		return true;
+	}
+
+	// Packs don't change once mounted, so their entries are hashed straight from the mapping
+	const terra::PackFile::Entry *Entry;
+	const terra::PackFile *Pack = terra::FindPacked(Filename, Entry);
+	if (Pack == nullptr)
+		return false;
+	Hash = terra::HashData(Pack->GetData(*Entry), Entry->StoredSize);
+	return true;
+}
+
+void terra::LevelCache::SetBudget(unsigned long NewBudget){
+	Budget = NewBudget;
+	Trim(Budget);
+}
+
+void terra::LevelCache::Trim(unsigned long Limit){
+	// Drop the least recently used levels until the cache fits
+	while (Used > Limit && !Uses.empty()){
+		auto Found = Levels.find(Uses.front());
+		Used -= Found->second.Size;
+		Levels.erase(Found);
+		Uses.pop_front();
+	}
+}
@@ -0,0 +1,97 @@
+#ifndef TERRA_LEVELCACHE_HPP
+#define TERRA_LEVELCACHE_HPP
+
+#include <cstdint>
+#include <ctime>
+#include <list>
+#include <map>
+#include <string>
+#include "LevelData.hpp"
+
+namespace terra{
+	/*!
+	 * \brief Parsed level cache
+	 *
+	 * Keeps the parsed form of recently loaded levels, keyed by the hash of the file they were loaded from, so that going back to a level skips reading and parsing it. The least recently used levels are dropped to keep the cache within its memory budget.
+	 *
+	 * The hash of each file is remembered along with its size and modification time, so a file that hasn't changed isn't read again just to hash it.
+	 */
+	class LevelCache{
+		private:
+			struct CachedLevel{
+				LevelData Level;
+				unsigned long Size;
+				std::list<uint64_t>::iterator Use;
+			};
+			struct Source{
+				uint64_t Hash;
+				std::time_t ModificationTime;
+				unsigned long Size;
+			};
+			unsigned long Budget;
+			std::map<uint64_t, CachedLevel> Levels;
+			std::map<std::string, Source> Sources;
+			unsigned long Used;
+			std::list<uint64_t> Uses;
+			void Trim(unsigned long Limit);
+			LevelCache(const LevelCache &Copy);
+			LevelCache &operator=(const LevelCache &Copy);
+		public:
+			/*!
+			 * \param NewBudget The most memory the cached levels may use, in bytes
+			 *
+			 * Create an empty cache.
+			 */
+			LevelCache(unsigned long NewBudget);
+
+			/*!
+			 * \param Hash The hash of the level's file
+			 * \param Level The parsed level, which is moved into the cache
+			 * \return The cached level, or a null pointer if the level is larger than the whole budget, in which case it is left as it was
+			 *
+			 * Add a level to the cache, dropping the least recently used levels to make room for it.
+			 */
+			const LevelData *Add(uint64_t Hash, LevelData &Level);
+
+			/*!
+			 * Drop every cached level and remembered hash.
+			 */
+			void Clear();
+
+			/*!
+			 * \param Hash The hash of the level's file
+			 * \return The cached level, or a null pointer if it isn't cached
+			 *
+			 * Find a cached level, and mark it as the most recently used.
+			 */
+			const LevelData *Find(uint64_t Hash);
+
+			/*!
+			 * \return The most memory the cached levels may use, in bytes
+			 */
+			const unsigned long GetBudget();
+
+			/*!
+			 * \return The memory the cached levels are estimated to use, in bytes
+			 */
+			const unsigned long GetUsed();
+
+			/*!
+			 * \param Filename The name of the level, or of its compiled form
+			 * \param Hash Set to the hash of the file the level would be loaded from
+			 * \return True if the file was found, false if neither it nor any pack has it
+			 *
+			 * Work out which level would be loaded for a name. Loose files are hashed as they are on disk, compressed or not, and packed files as they are stored in the pack.
+			 */
+			bool Identify(const std::string &Filename, uint64_t &Hash);
+
+			/*!
+			 * \param NewBudget The most memory the cached levels may use, in bytes, or 0 to turn the cache off
+			 *
+			 * Change the budget, dropping levels if the cache is now over it.
+			 */
+			void SetBudget(unsigned long NewBudget);
+	};
+}
+
+#endif
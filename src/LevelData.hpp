@@ -0,0 +1,28 @@
+#ifndef TERRA_LEVELDATA_HPP
+#define TERRA_LEVELDATA_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include "LevelLayerData.hpp"
+
+namespace terra{
+	/*!
+	 * \brief Level Data
+	 *
+	 * A structure containing everything that has been extracted from a level file, either the Ogmo XML or its compiled form.
+	 */
+	struct LevelData{
+		/*!
+		 * The values set by the level.
+		 */
+		std::map<std::string, std::string> Values;
+
+		/*!
+		 * The layers of the level.
+		 */
+		std::vector<LevelLayerData> Layers;
+	};
+}
+
+#endif
@@ -0,0 +1,291 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <vector>
+#include "LevelFile.hpp"
+#include "MappedFile.hpp"
+
+namespace{
+	// The file is laid out as the header, the string offsets, the arrays in the order of the header's counts, then the string characters
+	// Grid words are 64 bits but may not be aligned, so they are only ever copied
+	struct Header{
+		char Magic[4];
+		uint32_t ByteOrder;
+		uint32_t Version;
+		uint32_t StringCount;
+		uint32_t StringBytes;
+		uint32_t ValueCount;
+		uint32_t LayerCount;
+		uint32_t TileCount;
+		uint32_t ObjectCount;
+		uint32_t PairCount;
+		uint32_t NodeCount;
+		uint32_t GridWordCount;
+	};
+	struct PackedPair{
+		uint32_t Name;
+		uint32_t Value;
+	};
+	struct PackedLayer{
+		uint32_t Name;
+		uint32_t FirstTile;
+		uint32_t TileCount;
+		uint32_t FirstObject;
+		uint32_t ObjectCount;
+		uint32_t GridColumns;
+		uint32_t GridRows;
+		uint32_t GridCellWidth;
+		uint32_t GridCellHeight;
+		uint32_t FirstGridWord;
+	};
+	struct PackedTile{
+		float X;
+		float Y;
+		uint32_t Tileset;
+		uint32_t TileX;
+		uint32_t TileY;
+		uint32_t Width;
+		uint32_t Height;
+	};
+	struct PackedObject{
+		uint32_t Name;
+		float X;
+		float Y;
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t FirstPair;
+		uint32_t PairCount;
+		uint32_t FirstNode;
+		uint32_t NodeCount;
+	};
+	struct PackedNode{
+		float X;
+		float Y;
+	};
+	const char Magic[4] = {'T', 'L', 'V', 'L'};
+	const uint32_t ByteOrder = 0x01020304;
+
+	// Gives every distinct string an index, in the order they were first seen
+	class StringTable{
+		private:
+			std::map<std::string, uint32_t> Indices;
+		public:
+			std::vector<const std::string *> Strings;
+			uint32_t Intern(const std::string &String){
+				auto Found = Indices.find(String);
+				if (Found != Indices.end())
+					return Found->second;
+				uint32_t Index = Strings.size();
+				Strings.push_back(&Indices.insert(std::make_pair(String, Index)).first->first);
+				return Index;
+			}
+	};
+
+	template <typename T> void WriteArray(std::ofstream &File, const std::vector<T> &Array){
+		if (!Array.empty())
+			File.write(reinterpret_cast<const char *>(&Array[0]), Array.size()*sizeof(T));
+	}
+}
+
+std::string terra::LevelFile::GetCompiledName(const std::string &Filename){
+	return Filename+"c";
+}
+
+bool terra::LevelFile::Read(const std::string &Filename, terra::LevelData &Level, std::string &Problem){
+	terra::MappedFile File;
+	if (!File.Open(Filename)){
+		Problem = "unable to open the file";
+		return false;
+	}
+	return Read(File.GetData(), File.GetSize(), Level, Problem);
+}
+
+bool terra::LevelFile::Read(const char *Data, unsigned long Size, terra::LevelData &Level, std::string &Problem){
+	// Check the header before trusting any of the counts in it
+	if (Size < sizeof(Header)){
+		Problem = "the file is too small";
+		return false;
+	}
+	const Header *Head = reinterpret_cast<const Header *>(Data);
+	if (memcmp(Head->Magic, Magic, sizeof(Magic)) != 0){
+		Problem = "the file is not a compiled level";
+		return false;
+	}
+	if (Head->ByteOrder != ByteOrder || Head->Version != Version){
+		Problem = "the file was compiled for another version or machine";
+		return false;
+	}
+	uint64_t Expected = sizeof(Header)+(uint64_t(Head->StringCount)+1)*sizeof(uint32_t)+uint64_t(Head->ValueCount)*sizeof(PackedPair)+uint64_t(Head->LayerCount)*sizeof(PackedLayer)+uint64_t(Head->TileCount)*sizeof(PackedTile)+uint64_t(Head->ObjectCount)*sizeof(PackedObject)+uint64_t(Head->PairCount)*sizeof(PackedPair)+uint64_t(Head->NodeCount)*sizeof(PackedNode)+uint64_t(Head->GridWordCount)*sizeof(uint64_t)+Head->StringBytes;
+	if (Expected != Size){
+		Problem = "the file is damaged";
+		return false;
+	}
+
+	// Find each array, the header keeps them all aligned
+	const uint32_t *Offsets = reinterpret_cast<const uint32_t *>(Head+1);
+	const PackedPair *Values = reinterpret_cast<const PackedPair *>(Offsets+Head->StringCount+1);
+	const PackedLayer *Layers = reinterpret_cast<const PackedLayer *>(Values+Head->ValueCount);
+	const PackedTile *Tiles = reinterpret_cast<const PackedTile *>(Layers+Head->LayerCount);
+	const PackedObject *Objects = reinterpret_cast<const PackedObject *>(Tiles+Head->TileCount);
+	const PackedPair *Pairs = reinterpret_cast<const PackedPair *>(Objects+Head->ObjectCount);
+	const PackedNode *Nodes = reinterpret_cast<const PackedNode *>(Pairs+Head->PairCount);
+	const char *GridWords = reinterpret_cast<const char *>(Nodes+Head->NodeCount);
+	const char *Characters = GridWords+uint64_t(Head->GridWordCount)*sizeof(uint64_t);
+
+	// Unpack the strings once, so every tile and object can share them
+	std::vector<std::string> Strings(Head->StringCount);
+	for (uint32_t i = 0; i < Head->StringCount; ++i){
+		if (Offsets[i] > Offsets[i+1] || Offsets[i+1] > Head->StringBytes){
+			Problem = "the string table is damaged";
+			return false;
+		}
+		Strings[i].assign(Characters+Offsets[i], Offsets[i+1]-Offsets[i]);
+	}
+
+	// Every index has to be checked, a damaged file must not crash the game
+	for (uint32_t i = 0; i < Head->ValueCount; ++i)
+		if (Values[i].Name >= Head->StringCount || Values[i].Value >= Head->StringCount){
+			Problem = "a level value is damaged";
+			return false;
+		}
+	for (uint32_t i = 0; i < Head->LayerCount; ++i)
+		if (Layers[i].Name >= Head->StringCount || uint64_t(Layers[i].FirstTile)+Layers[i].TileCount > Head->TileCount || uint64_t(Layers[i].FirstObject)+Layers[i].ObjectCount > Head->ObjectCount || uint64_t(Layers[i].FirstGridWord)+(uint64_t(Layers[i].GridColumns)+63)/64*Layers[i].GridRows > Head->GridWordCount){
+			Problem = "a layer is damaged";
+			return false;
+		}
+	for (uint32_t i = 0; i < Head->TileCount; ++i)
+		if (Tiles[i].Tileset >= Head->StringCount){
+			Problem = "a tile is damaged";
+			return false;
+		}
+	for (uint32_t i = 0; i < Head->ObjectCount; ++i)
+		if (Objects[i].Name >= Head->StringCount || uint64_t(Objects[i].FirstPair)+Objects[i].PairCount > Head->PairCount || uint64_t(Objects[i].FirstNode)+Objects[i].NodeCount > Head->NodeCount){
+			Problem = "an object is damaged";
+			return false;
+		}
+	for (uint32_t i = 0; i < Head->PairCount; ++i)
+		if (Pairs[i].Name >= Head->StringCount || Pairs[i].Value >= Head->StringCount){
+			Problem = "an object value is damaged";
+			return false;
+		}
+
+	// Now fill in the level
+	for (uint32_t i = 0; i < Head->ValueCount; ++i)
+		Level.Values[Strings[Values[i].Name]] = Strings[Values[i].Value];
+	Level.Layers.resize(Head->LayerCount);
+	for (uint32_t i = 0; i < Head->LayerCount; ++i){
+		terra::LevelLayerData &Layer = Level.Layers[i];
+		Layer.Name = Strings[Layers[i].Name];
+
+		// Tiles
+		Layer.Tiles.resize(Layers[i].TileCount);
+		for (uint32_t j = 0; j < Layers[i].TileCount; ++j){
+			const PackedTile &Packed = Tiles[Layers[i].FirstTile+j];
+			terra::OgmoTile &Tile = Layer.Tiles[j];
+			Tile.Tileset = Strings[Packed.Tileset];
+			Tile.TilePosition = sf::Vector2<unsigned int>(Packed.TileX, Packed.TileY);
+			Tile.TileSize = sf::Vector2<unsigned int>(Packed.Width, Packed.Height);
+			Tile.Position = sf::Vector2f(Packed.X, Packed.Y);
+		}
+
+		// Grid cells
+		if (Layers[i].GridColumns != 0 && Layers[i].GridRows != 0)
+			Layer.Grid.Reset(Layers[i].GridColumns, Layers[i].GridRows, sf::Vector2<unsigned int>(Layers[i].GridCellWidth, Layers[i].GridCellHeight), GridWords+uint64_t(Layers[i].FirstGridWord)*sizeof(uint64_t));
+
+		// Objects
+		Layer.Objects.resize(Layers[i].ObjectCount);
+		for (uint32_t j = 0; j < Layers[i].ObjectCount; ++j){
+			const PackedObject &Packed = Objects[Layers[i].FirstObject+j];
+			terra::OgmoObject &Object = Layer.Objects[j];
+			Object.Name = Strings[Packed.Name];
+			Object.Position = sf::Vector2f(Packed.X, Packed.Y);
+			Object.Size = sf::Vector2<unsigned int>(Packed.Width, Packed.Height);
+			for (uint32_t k = 0; k < Packed.PairCount; ++k)
+				Object.Values[Strings[Pairs[Packed.FirstPair+k].Name]] = Strings[Pairs[Packed.FirstPair+k].Value];
+			for (uint32_t k = 0; k < Packed.NodeCount; ++k)
+				Object.Nodes.push_back(sf::Vector2f(Nodes[Packed.FirstNode+k].X, Nodes[Packed.FirstNode+k].Y));
+		}
+	}
+	return true;
+}
+
+bool terra::LevelFile::Write(const std::string &Filename, const terra::LevelData &Level, std::string &Problem){
+	// Flatten the level into arrays, interning every string along the way
+	StringTable Strings;
+	std::vector<PackedPair> Values;
+	std::vector<PackedLayer> Layers;
+	std::vector<PackedTile> Tiles;
+	std::vector<PackedObject> Objects;
+	std::vector<PackedPair> Pairs;
+	std::vector<PackedNode> Nodes;
+	std::vector<uint64_t> GridWords;
+	for (auto i = Level.Values.begin(); i != Level.Values.end(); ++i){
+		PackedPair Value = {Strings.Intern(i->first), Strings.Intern(i->second)};
+		Values.push_back(Value);
+	}
+	for (auto i = Level.Layers.begin(); i != Level.Layers.end(); ++i){
+		PackedLayer Layer = {Strings.Intern(i->Name), uint32_t(Tiles.size()), uint32_t(i->Tiles.size()), uint32_t(Objects.size()), uint32_t(i->Objects.size()), i->Grid.GetColumns(), i->Grid.GetRows(), i->Grid.GetCellSize().x, i->Grid.GetCellSize().y, uint32_t(GridWords.size())};
+		Layers.push_back(Layer);
+		GridWords.insert(GridWords.end(), i->Grid.GetWords().begin(), i->Grid.GetWords().end());
+		for (auto j = i->Tiles.begin(); j != i->Tiles.end(); ++j){
+			PackedTile Tile = {j->Position.x, j->Position.y, Strings.Intern(j->Tileset), j->TilePosition.x, j->TilePosition.y, j->TileSize.x, j->TileSize.y};
+			Tiles.push_back(Tile);
+		}
+		for (auto j = i->Objects.begin(); j != i->Objects.end(); ++j){
+			PackedObject Object = {Strings.Intern(j->Name), j->Position.x, j->Position.y, j->Size.x, j->Size.y, uint32_t(Pairs.size()), uint32_t(j->Values.size()), uint32_t(Nodes.size()), uint32_t(j->Nodes.size())};
+			Objects.push_back(Object);
+			for (auto k = j->Values.begin(); k != j->Values.end(); ++k){
+				PackedPair Pair = {Strings.Intern(k->first), Strings.Intern(k->second)};
+				Pairs.push_back(Pair);
+			}
+			for (auto k = j->Nodes.begin(); k != j->Nodes.end(); ++k){
+				PackedNode Node = {k->x, k->y};
+				Nodes.push_back(Node);
+			}
+		}
+	}
+
+	// Lay the strings out end to end
+	std::vector<uint32_t> Offsets(1, 0);
+	std::string Characters;
+	for (auto i = Strings.Strings.begin(); i != Strings.Strings.end(); ++i){
+		Characters += **i;
+		Offsets.push_back(Characters.size());
+	}
+
+	// Write it all out
+	Header Head;
+	memcpy(Head.Magic, Magic, sizeof(Magic));
+	Head.ByteOrder = ByteOrder;
+	Head.Version = Version;
+	Head.StringCount = Strings.Strings.size();
+	Head.StringBytes = Characters.size();
+	Head.ValueCount = Values.size();
+	Head.LayerCount = Layers.size();
+	Head.TileCount = Tiles.size();
+	Head.ObjectCount = Objects.size();
+	Head.PairCount = Pairs.size();
+	Head.NodeCount = Nodes.size();
+	Head.GridWordCount = GridWords.size();
+	std::ofstream File(Filename.c_str(), std::ios::binary);
+	if (!File){
+		Problem = "unable to create the file";
+		return false;
+	}
+	File.write(reinterpret_cast<const char *>(&Head), sizeof(Head));
+	WriteArray(File, Offsets);
+	WriteArray(File, Values);
+	WriteArray(File, Layers);
+	WriteArray(File, Tiles);
+	WriteArray(File, Objects);
+	WriteArray(File, Pairs);
+	WriteArray(File, Nodes);
+	WriteArray(File, GridWords);
+	File.write(Characters.data(), Characters.size());
+	if (!File.good()){
+		Problem = "unable to write the file";
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,61 @@
+#ifndef TERRA_LEVELFILE_HPP
+#define TERRA_LEVELFILE_HPP
+
+#include <string>
+#include "LevelData.hpp"
+
+namespace terra{
+	/*!
+	 * \brief Compiled level files
+	 *
+	 * Reads and writes the compiled form of Ogmo levels made by terra_levelc. A compiled level is a small header followed by flat arrays of layers, tiles, objects, value pairs, and nodes, with every name and value stored once in a table of interned strings. Loading one is a memory mapping and a walk over those arrays, without any text to parse.
+	 */
+	class LevelFile{
+		public:
+			/*!
+			 * The version of the format that is written, and the only one that is read.
+			 */
+			static const unsigned int Version = 2;
+
+			/*!
+			 * \param Filename The filename of an Ogmo level
+			 * \return The filename of the level's compiled form
+			 *
+			 * Find where the compiled form of a level is kept, which is next to the level with a "c" on the end of its extension.
+			 */
+			static std::string GetCompiledName(const std::string &Filename);
+
+			/*!
+			 * \param Filename The filename of the compiled level
+			 * \param Level The level data to fill in
+			 * \param Problem Set to a description of what went wrong if the level can't be read
+			 * \return True if the level was read, false if the file is missing, from another version, or damaged
+			 *
+			 * Read a compiled level.
+			 */
+			static bool Read(const std::string &Filename, LevelData &Level, std::string &Problem);
+
+			/*!
+			 * \param Data The contents of a compiled level, aligned to at least 4 bytes
+			 * \param Size The size of the contents
+			 * \param Level The level data to fill in
+			 * \param Problem Set to a description of what went wrong if the level can't be read
+			 * \return True if the level was read, false if it is from another version, or damaged
+			 *
+			 * Read a compiled level that is already in memory, such as one inside a pack.
+			 */
+			static bool Read(const char *Data, unsigned long Size, LevelData &Level, std::string &Problem);
+
+			/*!
+			 * \param Filename The filename to write the compiled level to
+			 * \param Level The level data to write
+			 * \param Problem Set to a description of what went wrong if the level can't be written
+			 * \return True if the level was written, false otherwise
+			 *
+			 * Write a compiled level.
+			 */
+			static bool Write(const std::string &Filename, const LevelData &Level, std::string &Problem);
+	};
+}
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef TERRA_LEVELLAYERDATA_HPP
+#define TERRA_LEVELLAYERDATA_HPP
+
+#include <string>
+#include <vector>
+#include "CollisionGrid.hpp"
+#include "OgmoObject.hpp"
+#include "OgmoTile.hpp"
+
+namespace terra{
+	/*!
+	 * \brief Level Layer Data
+	 *
+	 * A structure containing the tiles, objects, or grid cells of one layer of a level, before they are turned into items.
+	 */
+	struct LevelLayerData{
+		/*!
+		 * The name of the layer, as registered in the project file.
+		 */
+		std::string Name;
+
+		/*!
+		 * The tiles of the layer, if it is a tile layer.
+		 */
+		std::vector<OgmoTile> Tiles;
+
+		/*!
+		 * The objects of the layer, if it is an object layer. Only the name, position, size, values, and nodes of each object are used, and they are laid over the object's definition from the project file.
+		 */
+		std::vector<OgmoObject> Objects;
+
+		/*!
+		 * The cells of the layer, if it is a grid layer.
+		 */
+		CollisionGrid Grid;
+	};
+}
+
+#endif
@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "Engine.hpp"
+#include "LevelLayerParser.hpp"
+#include "Utilities.hpp"
+
+terra::LevelLayerParser::TileAttributes::TileAttributes(){
+	X = nullptr;
+	Y = nullptr;
+	ID = nullptr;
+	TX = nullptr;
+	TY = nullptr;
+	Set = nullptr;
+}
+
+void terra::LevelLayerParser::TileAttributes::Pick(const char *Name, const char *Value){
+	if (strcmp(Name, "x") == 0)
+		X = Value;
+	else if (strcmp(Name, "y") == 0)
+		Y = Value;
+	else if (strcmp(Name, "id") == 0)
+		ID = Value;
+	else if (strcmp(Name, "tx") == 0)
+		TX = Value;
+	else if (strcmp(Name, "ty") == 0)
+		TY = Value;
+	else if (strcmp(Name, "set") == 0)
+		Set = Value;
+}
+
+terra::LevelLayerParser::LevelLayerParser(terra::LevelLayerData &NewData, const terra::OgmoTileLayer *NewTileDefinition, const std::map<std::string, terra::TilesetPlan> &NewPlans, const std::map<std::string, terra::OgmoObject> &NewObjects) : Data(NewData), Objects(NewObjects), Plans(NewPlans){
+	GridColumn = 0;
+	GridColumns = 0;
+	GridDefinition = nullptr;
+	GridRow = 0;
+	GridRows = 0;
+	GridRunStart = 0;
+	HasX = false;
+	HasY = false;
+	InObject = false;
+	Plan = nullptr;
+	TileDefinition = NewTileDefinition;
+	TilesReady = false;
+}
+
+void terra::LevelLayerParser::AddGridRect(const char *X, const char *Y, const char *Width, const char *Height){
+	if (GridDefinition == nullptr || X == nullptr || Y == nullptr || Width == nullptr || Height == nullptr)
+		return;
+
+	// Turn the pixels into cells, counting any cell the rectangle reaches into
+	float Left = std::max(terra::ParseNumber(X), 0.f)/GridDefinition->CellSize.x;
+	float Top = std::max(terra::ParseNumber(Y), 0.f)/GridDefinition->CellSize.y;
+	float Right = Left+std::max(terra::ParseNumber(Width), 0.f)/GridDefinition->CellSize.x;
+	float Bottom = Top+std::max(terra::ParseNumber(Height), 0.f)/GridDefinition->CellSize.y;
+	sf::Rect<unsigned int> Cells(std::floor(Left), std::floor(Top), 0, 0);
+	Cells.Width = std::ceil(Right)-Cells.Left;
+	Cells.Height = std::ceil(Bottom)-Cells.Top;
+	if (Cells.Width == 0 || Cells.Height == 0)
+		return;
+	GridRects.push_back(Cells);
+	GridColumns = std::max(GridColumns, Cells.Left+Cells.Width);
+	GridRows = std::max(GridRows, Cells.Top+Cells.Height);
+}
+
+void terra::LevelLayerParser::AddGridText(const char *Text, unsigned int Length){
+	if (GridDefinition == nullptr)
+		return;
+
+	// Solid cells are gathered into runs along each row, so the grid is filled a run at a time once its size is known
+	for (const char *i = Text; i != Text+Length; ++i){
+		bool Solid = GridColumn > GridRunStart;
+		if (*i == GridDefinition->RowEnd){
+			// Line breaks before the first row are only formatting
+			if (GridRows == 0)
+				continue;
+			if (Solid)
+				GridRects.push_back(sf::Rect<unsigned int>(GridRunStart, GridRow, GridColumn-GridRunStart, 1));
+			++GridRow;
+			GridColumn = 0;
+			GridRunStart = 0;
+			continue;
+		}
+		if (*i == '\r' || *i == '\n' || *i == ' ' || *i == '\t')
+			continue;
+		if (*i != '1'){
+			if (Solid)
+				GridRects.push_back(sf::Rect<unsigned int>(GridRunStart, GridRow, GridColumn-GridRunStart, 1));
+			GridRunStart = GridColumn+1;
+		}
+		++GridColumn;
+		GridColumns = std::max(GridColumns, GridColumn);
+		GridRows = std::max(GridRows, GridRow+1);
+	}
+}
+
+void terra::LevelLayerParser::AddNode(const char *X, const char *Y){
+	// Validate the node
+	if (!InObject || X == nullptr || Y == nullptr)
+		return;
+	Current.Nodes.push_back(sf::Vector2f(terra::ParseNumber(X), terra::ParseNumber(Y)));
+}
+
+void terra::LevelLayerParser::AddTile(const terra::LevelLayerParser::TileAttributes &Attributes){
+	// First check if the tile is valid
+	if (!TilesReady || Attributes.X == nullptr || Attributes.Y == nullptr)
+		return;
+
+	// Switch tilesets only when the tile's differs from the last one (if needed)
+	if (TileDefinition->MultipleTilesets){
+		if (Attributes.Set == nullptr)
+			return;
+		if (Plan == nullptr || PlanName != Attributes.Set){
+			auto Found = Plans.find(Attributes.Set);
+			Plan = Found == Plans.end() ? nullptr : &Found->second;
+			PlanName = Attributes.Set;
+		}
+		if (Plan == nullptr)
+			return;
+		if (!TileDefinition->ExportTileSize)
+			TileSize = Plan->TileSize;
+	}
+
+	// Parse the position of the tile in the tileset
+	sf::Vector2<unsigned int> TilePosition;
+	if (TileDefinition->ExportTileIDs){
+		// Check if the tile id is given
+		if (Attributes.ID == nullptr)
+			return;
+		unsigned int Index = terra::ParseInteger(Attributes.ID);
+
+		// Tiles of the tileset's own size come straight out of the plan's table
+		if (TileSize == Plan->TileSize){
+			if (Index >= Plan->Positions.size())
+				return;
+			TilePosition = Plan->Positions[Index];
+		}
+		else{
+			// Tiles of a custom size have to be worked out, making sure the id isn't too large
+			unsigned int IDWidth = Plan->ImageSize.x/TileSize.x;
+			unsigned int IDHeight = Plan->ImageSize.y/TileSize.y;
+			if (Index >= IDWidth*IDHeight)
+				return;
+			TilePosition.x = Index%IDWidth*TileSize.x;
+			TilePosition.y = Index/IDWidth*TileSize.y;
+		}
+	}
+	else{
+		// Check if the tile position is given
+		if (Attributes.TX == nullptr || Attributes.TY == nullptr)
+			return;
+
+		// We don't have to do math here like we did with ided tiles. Yay
+		TilePosition.x = terra::ParseInteger(Attributes.TX);
+		TilePosition.y = terra::ParseInteger(Attributes.TY);
+	}
+
+	// Keep the tile for BuildLevel
+	terra::OgmoTile NextTile;
+	NextTile.Tileset = Plan->Image;
+	NextTile.TilePosition = TilePosition;
+	NextTile.TileSize = TileSize;
+	NextTile.Position = sf::Vector2f(terra::ParseNumber(Attributes.X), terra::ParseNumber(Attributes.Y));
+	Data.Tiles.push_back(NextTile);
+}
+
+void terra::LevelLayerParser::BeginGrid(const terra::OgmoGridLayer &Definition){
+	GridColumn = 0;
+	GridColumns = 0;
+	GridDefinition = &Definition;
+	GridRects.clear();
+	GridRow = 0;
+	GridRows = 0;
+	GridRunStart = 0;
+}
+
+bool terra::LevelLayerParser::BeginObject(const char *Name){
+	// Verify that the object exists
+	InObject = false;
+	auto Definition = Objects.find(Name);
+	if (Definition == Objects.end()){
+		terra::Engine::Get().Warning(std::string("Object of name \"") + Name + "\" does not exist\n");
+		return false;
+	}
+
+	// Start from the object's definition
+	Current = Definition->second;
+	HasX = false;
+	HasY = false;
+	InObject = true;
+	return true;
+}
+
+bool terra::LevelLayerParser::BeginTiles(const char *Set, const char *TileWidth, const char *TileHeight){
+	// Give up if the tileset is needed but not given
+	TilesReady = false;
+	if (TileDefinition == nullptr || (Set == nullptr && !TileDefinition->MultipleTilesets))
+		return false;
+
+	// Prepare the tileset's plan (if needed)
+	if (!TileDefinition->MultipleTilesets){
+		auto Found = Plans.find(Set);
+		if (Found == Plans.end())
+			return false;
+		Plan = &Found->second;
+		PlanName = Set;
+	}
+
+	// Read in the tile size (if needed)
+	if (TileDefinition->ExportTileSize){
+		if (TileWidth == nullptr || TileHeight == nullptr)
+			return false;
+		TileSize.x = terra::ParseInteger(TileWidth);
+		TileSize.y = terra::ParseInteger(TileHeight);
+		if (TileSize.x == 0 || TileSize.y == 0)
+			return false;
+	}
+	else if (!TileDefinition->MultipleTilesets)
+		TileSize = Plan->TileSize;
+	TilesReady = true;
+	return true;
+}
+
+void terra::LevelLayerParser::EndGrid(){
+	if (GridDefinition == nullptr)
+		return;
+	if (GridColumn > GridRunStart)
+		GridRects.push_back(sf::Rect<unsigned int>(GridRunStart, GridRow, GridColumn-GridRunStart, 1));
+	Data.Grid.Reset(GridColumns, GridRows, GridDefinition->CellSize);
+	for (auto i = GridRects.begin(); i != GridRects.end(); ++i)
+		Data.Grid.Fill(i->Left, i->Top, i->Width, i->Height);
+	GridDefinition = nullptr;
+	GridRects.clear();
+}
+
+void terra::LevelLayerParser::EndObject(){
+	// Objects without a position are invalid
+	if (InObject && HasX && HasY)
+		Data.Objects.push_back(Current);
+	InObject = false;
+}
+
+void terra::LevelLayerParser::SetObjectAttribute(const char *Name, const char *Value){
+	if (!InObject)
+		return;
+
+	// The position and size of the object
+	if (strcmp(Name, "x") == 0){
+		Current.Position.x = terra::ParseNumber(Value);
+		HasX = true;
+	}
+	else if (strcmp(Name, "y") == 0){
+		Current.Position.y = terra::ParseNumber(Value);
+		HasY = true;
+	}
+	else if (strcmp(Name, "width") == 0){
+		if (Current.ResizableX)
+			Current.Size.x = terra::ParseInteger(Value);
+	}
+	else if (strcmp(Name, "height") == 0){
+		if (Current.ResizableY)
+			Current.Size.y = terra::ParseInteger(Value);
+	}
+
+	// Everything else is one of the object's values
+	else{
+		auto Found = Current.Values.find(Name);
+		if (Found == Current.Values.end()){
+			terra::Engine::Get().Warning(std::string("Value of name \"") + Name + "\" does not exist\n");
+			return;
+		}
+		Found->second = Value;
+	}
+}
@@ -0,0 +1,159 @@
+#ifndef TERRA_LEVELLAYERPARSER_HPP
+#define TERRA_LEVELLAYERPARSER_HPP
+
+#include <map>
+#include <SFML/System.hpp>
+#include <string>
+#include <vector>
+#include "LevelLayerData.hpp"
+#include "OgmoGridLayer.hpp"
+#include "OgmoObject.hpp"
+#include "OgmoTileLayer.hpp"
+#include "TilesetPlan.hpp"
+
+namespace terra{
+	/*!
+	 * \brief Level layer parser
+	 *
+	 * Turns the attributes and text of a level layer's elements into tiles, objects, and grid cells, without caring where the attributes came from. Both the RapidXML level parser and the streaming level parser feed their layers through it. It only reads the project's definitions, so layers can be parsed on several threads at once.
+	 */
+	class LevelLayerParser{
+		public:
+			/*!
+			 * \brief Tile Attributes
+			 *
+			 * The attributes of a single tile element that the parser uses.
+			 */
+			struct TileAttributes{
+				const char *X;
+				const char *Y;
+				const char *ID;
+				const char *TX;
+				const char *TY;
+				const char *Set;
+
+				/*!
+				 * Create a new set of attributes with none given.
+				 */
+				TileAttributes();
+
+				/*!
+				 * \param Name The name of an attribute
+				 * \param Value The value of the attribute
+				 *
+				 * Keep the attribute if it is one the parser uses.
+				 */
+				void Pick(const char *Name, const char *Value);
+			};
+		private:
+			OgmoObject Current;
+			LevelLayerData &Data;
+			unsigned int GridColumn;
+			unsigned int GridColumns;
+			const OgmoGridLayer *GridDefinition;
+			std::vector<sf::Rect<unsigned int>> GridRects;
+			unsigned int GridRow;
+			unsigned int GridRows;
+			unsigned int GridRunStart;
+			bool HasX;
+			bool HasY;
+			bool InObject;
+			const std::map<std::string, OgmoObject> &Objects;
+			const TilesetPlan *Plan;
+			std::string PlanName;
+			const std::map<std::string, TilesetPlan> &Plans;
+			const OgmoTileLayer *TileDefinition;
+			sf::Vector2<unsigned int> TileSize;
+			bool TilesReady;
+			LevelLayerParser(const LevelLayerParser &Copy);
+			LevelLayerParser &operator=(const LevelLayerParser &Copy);
+		public:
+			/*!
+			 * \param NewData The layer data to fill in
+			 * \param NewTileDefinition The definition of the layer if it is a tile layer, or a null pointer if it is an object layer
+			 * \param NewPlans The tileset plans of the project
+			 * \param NewObjects The object definitions of the project
+			 *
+			 * Create a new parser for one layer.
+			 */
+			LevelLayerParser(LevelLayerData &NewData, const OgmoTileLayer *NewTileDefinition, const std::map<std::string, TilesetPlan> &NewPlans, const std::map<std::string, OgmoObject> &NewObjects);
+
+			/*!
+			 * \param X The x attribute of the rectangle
+			 * \param Y The y attribute of the rectangle
+			 * \param Width The w attribute of the rectangle
+			 * \param Height The h attribute of the rectangle
+			 *
+			 * Add a rectangle of solid cells to a grid layer that was exported as rectangles. The rectangle is given in pixels.
+			 */
+			void AddGridRect(const char *X, const char *Y, const char *Width, const char *Height);
+
+			/*!
+			 * \param Text Some of the text of the layer's element
+			 * \param Length The length of the text
+			 *
+			 * Add cells to a grid layer, one character per cell with 1 for solid, and rows ending in the layer's newline. The text can be given in pieces.
+			 */
+			void AddGridText(const char *Text, unsigned int Length);
+
+			/*!
+			 * \param X The x attribute of the node
+			 * \param Y The y attribute of the node
+			 *
+			 * Add a node to the object being parsed.
+			 */
+			void AddNode(const char *X, const char *Y);
+
+			/*!
+			 * \param Attributes The attributes of the tile
+			 *
+			 * Parse a tile of a tile layer. Tiles are only kept once BeginTiles() has succeeded.
+			 */
+			void AddTile(const TileAttributes &Attributes);
+
+			/*!
+			 * \param Name The name of the object's element
+			 * \return True if the object is defined in the project, false otherwise
+			 *
+			 * Start parsing an object of an object layer, starting from its definition.
+			 */
+			bool BeginObject(const char *Name);
+
+			/*!
+			 * \param Definition The definition of the grid layer
+			 *
+			 * Start parsing the cells of a grid layer.
+			 */
+			void BeginGrid(const OgmoGridLayer &Definition);
+
+			/*!
+			 * \param Set The set attribute of the layer, or a null pointer if it has none
+			 * \param TileWidth The tileWidth attribute of the layer, or a null pointer if it has none
+			 * \param TileHeight The tileHeight attribute of the layer, or a null pointer if it has none
+			 * \return True if the layer's tiles can be parsed, false otherwise
+			 *
+			 * Start parsing the tiles of a tile layer from the attributes of the layer's element.
+			 */
+			bool BeginTiles(const char *Set, const char *TileWidth, const char *TileHeight);
+
+			/*!
+			 * Finish the grid layer being parsed, packing its cells into the layer's grid.
+			 */
+			void EndGrid();
+
+			/*!
+			 * Finish the object being parsed, keeping it if it had a position.
+			 */
+			void EndObject();
+
+			/*!
+			 * \param Name The name of an attribute of the object's element
+			 * \param Value The value of the attribute
+			 *
+			 * Set the position, size, or a value of the object being parsed.
+			 */
+			void SetObjectAttribute(const char *Name, const char *Value);
+	};
+}
+
+#endif
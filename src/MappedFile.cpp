@@ -0,0 +1,171 @@
+#include "MappedFile.hpp"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+namespace{
+	// Empty files can't be mapped, so read-only mappings of them all point here instead
+	char Empty[1] = {0};
+}
+
+terra::MappedFile::MappedFile(){
+	Data = nullptr;
+	Length = 0;
+	Size = 0;
+	Writable = false;
+#ifdef _WIN32
+	File = INVALID_HANDLE_VALUE;
+	Mapping = nullptr;
+#endif
+}
+
+void terra::MappedFile::Adopt(std::vector<char> &Contents){
+	Close();
+	if (Contents.empty())
+		Contents.push_back(0);
+	Buffer.swap(Contents);
+	Data = &Buffer[0];
+	Size = Buffer.size()-1;
+	Writable = true;
+}
+
+void terra::MappedFile::Close(){
+	// Contents that are kept in the buffer were never mapped
+	if (!Buffer.empty()){
+		std::vector<char>().swap(Buffer);
+		Data = nullptr;
+	}
+#ifdef _WIN32
+	if (Data != nullptr && Data != Empty)
+		UnmapViewOfFile(Data);
+	if (Mapping != nullptr)
+		CloseHandle(Mapping);
+	if (File != INVALID_HANDLE_VALUE)
+		CloseHandle(File);
+	File = INVALID_HANDLE_VALUE;
+	Mapping = nullptr;
+#else
+	if (Data != nullptr && Data != Empty)
+		munmap(Data, Length);
+#endif
+	Data = nullptr;
+	Length = 0;
+	Size = 0;
+	Writable = false;
+}
+
+const char *terra::MappedFile::GetData() const{
+	return Data;
+}
+
+const unsigned long terra::MappedFile::GetSize() const{
+	return Size;
+}
+
+char *terra::MappedFile::GetWritableData(){
+	return Writable ? Data : nullptr;
+}
+
+const bool terra::MappedFile::IsOpen() const{
+	return Data != nullptr;
+}
+
+bool terra::MappedFile::Open(const std::string &Filename, bool MakeWritable){
+	Close();
+#ifdef _WIN32
+	// Open the file and find its size
+	File = CreateFileA(Filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (File == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER FileSize;
+	if (!GetFileSizeEx(File, &FileSize)){
+		Close();
+		return false;
+	}
+
+	// Windows can't put a null character after a view, so writable files are read into a buffer with one instead
+	if (MakeWritable){
+		std::vector<char> Contents(FileSize.QuadPart+1, 0);
+		DWORD Read = 0;
+		bool Succeeded = FileSize.QuadPart == 0 || (::ReadFile(File, &Contents[0], DWORD(FileSize.QuadPart), &Read, nullptr) && Read == FileSize.QuadPart);
+		CloseHandle(File);
+		File = INVALID_HANDLE_VALUE;
+		if (!Succeeded)
+			return false;
+		Adopt(Contents);
+		return true;
+	}
+	if (FileSize.QuadPart == 0){
+		Data = Empty;
+		return true;
+	}
+
+	// Map the whole thing
+	Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (Mapping == nullptr){
+		Close();
+		return false;
+	}
+	Data = static_cast<char *>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+	if (Data == nullptr){
+		Close();
+		return false;
+	}
+	Size = FileSize.QuadPart;
+	Length = Size;
+#else
+	// Open the file and find its size
+	int File = open(Filename.c_str(), O_RDONLY);
+	if (File < 0)
+		return false;
+	struct stat Info;
+	if (fstat(File, &Info) != 0 || !S_ISREG(Info.st_mode)){
+		close(File);
+		return false;
+	}
+	if (Info.st_size == 0 && !MakeWritable){
+		close(File);
+		Data = Empty;
+		return true;
+	}
+
+	// Writable files get zeroed pages reserved with room for at least one extra byte, then the file is mapped over the start of them
+	void *Mapped;
+	if (MakeWritable){
+		unsigned long Page = sysconf(_SC_PAGESIZE);
+		Length = (Info.st_size/Page+1)*Page;
+		Mapped = mmap(nullptr, Length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (Mapped != MAP_FAILED && Info.st_size > 0 && mmap(Mapped, Info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, File, 0) == MAP_FAILED){
+			munmap(Mapped, Length);
+			Mapped = MAP_FAILED;
+		}
+	}
+	else{
+		Length = Info.st_size;
+		Mapped = mmap(nullptr, Length, PROT_READ, MAP_PRIVATE, File, 0);
+	}
+
+	// The mapping stays valid after the file is closed
+	close(File);
+	if (Mapped == MAP_FAILED){
+		Length = 0;
+		return false;
+	}
+	Data = static_cast<char *>(Mapped);
+	Size = Info.st_size;
+	Writable = MakeWritable;
+#endif
+	return true;
+}
+
+terra::MappedFile::~MappedFile(){
+	Close();
+}
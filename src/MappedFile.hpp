@@ -0,0 +1,88 @@
+#ifndef TERRA_MAPPEDFILE_HPP
+#define TERRA_MAPPEDFILE_HPP
+
+#include <string>
+#include <vector>
+
+namespace terra{
+	/*!
+	 * \brief Memory mapped file
+	 *
+	 * Maps a whole file into memory, so it can be used in place without copying it into a buffer first. A file can also be mapped copy-on-write with a null character after it, so parsers that work in place, like RapidXML, can be handed the file directly.
+	 */
+	class MappedFile{
+		private:
+			std::vector<char> Buffer;
+			char *Data;
+			unsigned long Length;
+			unsigned long Size;
+			bool Writable;
+#ifdef _WIN32
+			void *File;
+			void *Mapping;
+#endif
+			MappedFile(const MappedFile &Copy);
+			MappedFile &operator=(const MappedFile &Copy);
+		public:
+			/*!
+			 * Create a new mapping with no file.
+			 */
+			MappedFile();
+
+			/*!
+			 * \param Contents The contents to keep, followed by a null character, which are taken out of the vector
+			 *
+			 * Keep contents that were read some other way, such as by decompressing a file, as if they were a writable mapping.
+			 */
+			void Adopt(std::vector<char> &Contents);
+
+			/*!
+			 * Unmap the file, if one is mapped.
+			 */
+			void Close();
+
+			/*!
+			 * \return A pointer to the contents of the file, or a null pointer if no file is mapped
+			 *
+			 * Retrieve the contents of the file. They are not null-terminated.
+			 */
+			const char *GetData() const;
+
+			/*!
+			 * \return A pointer to the contents of the file, or a null pointer if no file is mapped or it was mapped read-only
+			 *
+			 * Retrieve the contents of a file that was mapped to be written to. They are followed by a null character, and changing them doesn't change the file.
+			 */
+			char *GetWritableData();
+
+			/*!
+			 * \return The size of the file in bytes
+			 *
+			 * Retrieve the size of the mapped file.
+			 */
+			const unsigned long GetSize() const;
+
+			/*!
+			 * \return True if a file is mapped, false otherwise
+			 *
+			 * Determines if a file is mapped.
+			 */
+			const bool IsOpen() const;
+
+			/*!
+			 * \param Filename The name of the file to map
+			 * \param MakeWritable Should the contents be writable and null-terminated?
+			 * \return True if the file was mapped, false otherwise
+			 *
+			 * Map a file into memory, unmapping the previous one. Pages of a writable mapping are only copied once they are written to.
+			 */
+			bool Open(const std::string &Filename, bool MakeWritable = false);
+
+			/*!
+			 * Unmap the file, if one is mapped.
+			 */
+			~MappedFile();
+	};
+}
+
+#endif
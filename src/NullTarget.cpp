@@ -0,0 +1,37 @@
+#include "NullTarget.hpp"
+
+bool terra::NullTarget::Activate(bool){
+	// Refusing to activate makes SFML skip every draw, and each draw asks once
+	++Ignored;
+	return false;
+}
+
+terra::NullTarget::NullTarget(unsigned int NewWidth, unsigned int NewHeight){
+	Width = NewWidth;
+	Height = NewHeight;
+	Ignored = 0;
+	Initialize();
+
+	// Setting up asks to activate as well, which isn't a draw
+	Ignored = 0;
+}
+
+unsigned int terra::NullTarget::GetHeight() const{
+	return Height;
+}
+
+const unsigned int terra::NullTarget::GetIgnoredCount() const{
+	return Ignored;
+}
+
+unsigned int terra::NullTarget::GetWidth() const{
+	return Width;
+}
+
+void terra::NullTarget::SetSize(unsigned int NewWidth, unsigned int NewHeight){
+	Width = NewWidth;
+	Height = NewHeight;
+}
+
+terra::NullTarget::~NullTarget(){
+}
@@ -0,0 +1,63 @@
+#ifndef TERRA_NULLTARGET_HPP
+#define TERRA_NULLTARGET_HPP
+
+#include <SFML/Graphics.hpp>
+
+namespace terra{
+	/*!
+	 * \brief A render target that draws nothing
+	 *
+	 * A render target which ignores everything drawn onto it. Backends that can't draw SFML drawables hand it to items, so that OnRender still has somewhere to draw and a view to read. It counts what it ignores, so that the engine can tell when items are going unseen.
+	 */
+	class NullTarget : public sf::RenderTarget{
+		private:
+			unsigned int Width;
+			unsigned int Height;
+			unsigned int Ignored;
+			bool Activate(bool);
+		public:
+			/*!
+			 * \param NewWidth The width the target pretends to have
+			 * \param NewHeight The height the target pretends to have
+			 *
+			 * Create a new null target.
+			 */
+			NullTarget(unsigned int NewWidth, unsigned int NewHeight);
+
+			/*!
+			 * \return The height of the target
+			 *
+			 * Retrieve the height the target pretends to have.
+			 */
+			unsigned int GetHeight() const;
+
+			/*!
+			 * \return The number of times something was drawn onto the target
+			 *
+			 * Retrieve how many draws the target has ignored since it was created.
+			 */
+			const unsigned int GetIgnoredCount() const;
+
+			/*!
+			 * \return The width of the target
+			 *
+			 * Retrieve the width the target pretends to have.
+			 */
+			unsigned int GetWidth() const;
+
+			/*!
+			 * \param NewWidth The new width
+			 * \param NewHeight The new height
+			 *
+			 * Change the size the target pretends to have.
+			 */
+			void SetSize(unsigned int NewWidth, unsigned int NewHeight);
+
+			/*!
+			 * Destroy the null target.
+			 */
+			~NullTarget();
+	};
+}
+
+#endif
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include "ObjectSpawner.hpp"
+
+namespace{
+	// Unlike sf::Rect::Intersects, objects with no size still count when they are inside the area
+	bool Overlaps(const sf::FloatRect &Area, const sf::Vector2f &Position, const sf::Vector2<unsigned int> &Size){
+		return Position.x <= Area.Left+Area.Width && Position.x+Size.x >= Area.Left && Position.y <= Area.Top+Area.Height && Position.y+Size.y >= Area.Top;
+	}
+
+	// Clamped so that a huge radius can't overflow
+	int ToCell(float Position){
+		return std::max<double>(std::min<double>(std::floor(Position/terra::ObjectSpawner::CellSize), INT_MAX/2), INT_MIN/2);
+	}
+
+	sf::FloatRect Grow(const sf::FloatRect &Area, float Distance){
+		return sf::FloatRect(Area.Left-Distance, Area.Top-Distance, Area.Width+2*Distance, Area.Height+2*Distance);
+	}
+}
+
+terra::ObjectSpawner::ObjectSpawner(){
+	DespawnRadius = 0.;
+	Radius = -1.;
+}
+
+void terra::ObjectSpawner::Add(const terra::OgmoObject &Descriptor, const std::shared_ptr<terra::Layer> &Target){
+	Entry NewEntry;
+	NewEntry.Descriptor = Descriptor;
+	NewEntry.Target = Target;
+	NewEntry.Spawned = false;
+	NewEntry.Gone = false;
+	Entries.push_back(NewEntry);
+
+	// Objects go in every cell they overlap, so a search only has to look at the cells around the view
+	int Left = ToCell(Descriptor.Position.x);
+	int Top = ToCell(Descriptor.Position.y);
+	int Right = ToCell(Descriptor.Position.x+Descriptor.Size.x);
+	int Bottom = ToCell(Descriptor.Position.y+Descriptor.Size.y);
+	for (int x = Left; x <= Right; ++x)
+		for (int y = Top; y <= Bottom; ++y)
+			Cells[std::make_pair(x, y)].push_back(Entries.size()-1);
+}
+
+void terra::ObjectSpawner::Clear(){
+	Cells.clear();
+	Entries.clear();
+	Live.clear();
+}
+
+void terra::ObjectSpawner::Despawn(const sf::FloatRect &View){
+	sf::FloatRect Area = Grow(View, DespawnRadius);
+	for (auto i = Live.begin(); i != Live.end();){
+		Entry &Current = Entries[*i];
+		std::shared_ptr<terra::Item> Instance = Current.Instance.lock();
+
+		// Objects that are still near stay, the ones that have already been removed by the game are gone for good
+		if (Instance && Overlaps(Area, Instance->GetPosition(), Instance->GetSize())){
+			++i;
+			continue;
+		}
+		Current.Spawned = false;
+		Current.Gone = true;
+		for (auto j = Current.Target->Begin(); Instance && j != Current.Target->End(); ++j)
+			if (*j == Instance){
+				Current.Target->RemoveItem(j);
+				Current.Gone = false;
+				break;
+			}
+		Current.Instance.reset();
+		*i = Live.back();
+		Live.pop_back();
+	}
+}
+
+const unsigned int terra::ObjectSpawner::GetPendingCount() const{
+	unsigned int Count = 0;
+	for (auto i = Entries.begin(); i != Entries.end(); ++i)
+		if (!i->Spawned && !i->Gone)
+			++Count;
+	return Count;
+}
+
+const bool terra::ObjectSpawner::IsEnabled() const{
+	return Radius >= 0.;
+}
+
+void terra::ObjectSpawner::SetRadius(float NewRadius, float NewDespawnRadius){
+	Radius = NewRadius;
+	DespawnRadius = NewDespawnRadius > 0. ? std::max(NewDespawnRadius, NewRadius) : 0.;
+}
+
+void terra::ObjectSpawner::Update(const sf::FloatRect &View, const std::function<std::shared_ptr<terra::Item> (const terra::OgmoObject &)> &Create){
+	if (Entries.empty() || !IsEnabled())
+		return;
+	if (DespawnRadius > 0.)
+		Despawn(View);
+
+	// Create the objects in a cell that have come near enough, and hand them to their layers
+	sf::FloatRect Area = Grow(View, Radius);
+	auto Visit = [&](const std::vector<unsigned int> &Indices){
+		for (auto i = Indices.begin(); i != Indices.end(); ++i){
+			Entry &Current = Entries[*i];
+			if (Current.Spawned || Current.Gone || !Overlaps(Area, Current.Descriptor.Position, Current.Descriptor.Size))
+				continue;
+			std::shared_ptr<terra::Item> Instance = Create(Current.Descriptor);
+			if (!Instance){
+				Current.Gone = true;
+				continue;
+			}
+			Current.Target->AddItem(Instance);
+			Current.Instance = Instance;
+			Current.Spawned = true;
+			if (DespawnRadius > 0.)
+				Live.push_back(*i);
+		}
+	};
+
+	// Look up the cells around the view, unless there are fewer cells in the whole level than that
+	int Left = ToCell(Area.Left);
+	int Top = ToCell(Area.Top);
+	int Right = ToCell(Area.Left+Area.Width);
+	int Bottom = ToCell(Area.Top+Area.Height);
+	if (uint64_t(Right-Left+1)*(Bottom-Top+1) > Cells.size()){
+		for (auto i = Cells.begin(); i != Cells.end(); ++i)
+			if (i->first.first >= Left && i->first.first <= Right && i->first.second >= Top && i->first.second <= Bottom)
+				Visit(i->second);
+		return;
+	}
+	for (int x = Left; x <= Right; ++x)
+		for (int y = Top; y <= Bottom; ++y){
+			auto Cell = Cells.find(std::make_pair(x, y));
+			if (Cell != Cells.end())
+				Visit(Cell->second);
+		}
+}
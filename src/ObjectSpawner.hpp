@@ -0,0 +1,89 @@
+#ifndef TERRA_OBJECTSPAWNER_HPP
+#define TERRA_OBJECTSPAWNER_HPP
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <SFML/Graphics.hpp>
+#include <utility>
+#include <vector>
+#include "Item.hpp"
+#include "Layer.hpp"
+#include "OgmoObject.hpp"
+
+namespace terra{
+	/*!
+	 * \brief Creates a level's objects as the view comes near them
+	 *
+	 * Holds the objects of a level that haven't been created yet, in a grid of cells over the world, so that only the cells around the view are looked at each frame. An object is created and added to its layer once it comes within a radius of the view. Objects can also be dropped again once they are far enough away, and are then created afresh from the level the next time the view comes near.
+	 *
+	 * Objects that the game removes from their layer are never created again.
+	 */
+	class ObjectSpawner{
+		private:
+			struct Entry{
+				OgmoObject Descriptor;
+				std::shared_ptr<Layer> Target;
+				std::weak_ptr<Item> Instance;
+				bool Spawned;
+				bool Gone;
+			};
+			std::map<std::pair<int, int>, std::vector<unsigned int>> Cells;
+			float DespawnRadius;
+			std::vector<Entry> Entries;
+			std::vector<unsigned int> Live;
+			float Radius;
+			void Despawn(const sf::FloatRect &View);
+		public:
+			/*!
+			 * The size of the cells of the grid the objects are kept in.
+			 */
+			static const int CellSize = 512;
+
+			/*!
+			 * Create a new spawner, with spawning turned off.
+			 */
+			ObjectSpawner();
+
+			/*!
+			 * \param Descriptor The object as it was read from the level, which must be defined and registered
+			 * \param Target The layer to add the object to once it is created
+			 *
+			 * Hold an object until the view comes near it.
+			 */
+			void Add(const OgmoObject &Descriptor, const std::shared_ptr<Layer> &Target);
+
+			/*!
+			 * Forget every object, created or not. Created objects stay in their layers.
+			 */
+			void Clear();
+
+			/*!
+			 * \return The number of objects held that haven't been created
+			 */
+			const unsigned int GetPendingCount() const;
+
+			/*!
+			 * \return True if objects are created as the view comes near them, false if they are all created when the level loads
+			 */
+			const bool IsEnabled() const;
+
+			/*!
+			 * \param NewRadius How far outside the view objects are created, or a negative number to create every object when the level loads
+			 * \param NewDespawnRadius How far outside the view created objects are dropped again, or 0 to keep them. Raised to at least NewRadius, so objects aren't dropped as soon as they are created.
+			 *
+			 * Set when objects are created and dropped.
+			 */
+			void SetRadius(float NewRadius, float NewDespawnRadius = 0.);
+
+			/*!
+			 * \param View The area of the world that can be seen
+			 * \param Create Creates an item from an object's descriptor, returning a null pointer if it can't
+			 *
+			 * Drop the created objects that are now too far from the view, if dropping is on, then create the objects that have come near it.
+			 */
+			void Update(const sf::FloatRect &View, const std::function<std::shared_ptr<Item> (const OgmoObject &)> &Create);
+	};
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef TERRA_OGMOGRIDLAYER_HPP
+#define TERRA_OGMOGRIDLAYER_HPP
+
+#include <SFML/System.hpp>
+
+namespace terra{
+	/*!
+	 * \brief Ogmo Grid Layers
+	 *
+	 * A structure containing information on grid layers that has been extracted from the project file.
+	 */
+	struct OgmoGridLayer{
+		/*!
+		 * The size of a cell of the grid.
+		 */
+		sf::Vector2<unsigned int> CellSize;
+
+		/*!
+		 * The character that ends each row of the grid, the last character of the layer's newLine.
+		 */
+		char RowEnd;
+	};
+}
+
+#endif
@@ -18,6 +18,11 @@ namespace terra{
 		 */
 		std::string Name;
 
+		/*!
+		 * The filename of the object's image, or an empty string if it has none.
+		 */
+		std::string Image;
+
 		/*!
 		 * The values of the object being loaded.
 		 */
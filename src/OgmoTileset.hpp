@@ -2,6 +2,8 @@
 #define TERRA_OGMOTILESET_HPP
 
 #include <string>
+#include <vector>
+#include "TileAnimation.hpp"
 
 namespace terra{
 	/*!
@@ -13,6 +15,7 @@ namespace terra{
 		std::string Image;
 		unsigned int TileWidth;
 		unsigned int TileHeight;
+		std::vector<TileAnimation> Animations;
 	};
 }
 
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <zlib.h>
+#include "PackFile.hpp"
+#include "Utilities.hpp"
+
+namespace{
+	// The pack is laid out as the header, the index, the names, then the files
+	struct Header{
+		char Magic[4];
+		uint32_t ByteOrder;
+		uint32_t Version;
+		uint32_t EntryCount;
+		uint64_t NamesSize;
+		uint64_t Reserved;
+	};
+	const char Magic[4] = {'T', 'P', 'A', 'K'};
+	const uint32_t ByteOrder = 0x01020304;
+	const uint64_t Alignment = 64;
+
+	uint64_t Align(uint64_t Offset){
+		return (Offset+Alignment-1)/Alignment*Alignment;
+	}
+}
+
+terra::PackFile::PackFile(){
+	Entries = nullptr;
+	EntryCount = 0;
+	Names = nullptr;
+}
+
+bool terra::PackFile::Extract(const terra::PackFile::Entry &Found, std::vector<char> &Contents) const{
+	Contents.resize(Found.Size+1);
+	Contents[Found.Size] = 0;
+	if (!Found.Compressed){
+		std::copy(GetData(Found), GetData(Found)+Found.Size, Contents.begin());
+		return true;
+	}
+
+	// The size of the file is known, so it can be inflated in one go
+	uLongf Size = Found.Size;
+	if (uncompress(reinterpret_cast<Bytef *>(&Contents[0]), &Size, reinterpret_cast<const Bytef *>(GetData(Found)), Found.StoredSize) != Z_OK || Size != Found.Size){
+		Contents.assign(1, 0);
+		return false;
+	}
+	return true;
+}
+
+const terra::PackFile::Entry *terra::PackFile::Find(const std::string &Name) const{
+	// Binary search for the first entry with the hash, then check the names of every entry that shares it
+	uint64_t Wanted = Hash(Name);
+	const Entry *Found = std::lower_bound(Entries, Entries+EntryCount, Wanted, [](const Entry &Left, uint64_t Right){ return Left.Hash < Right; });
+	for (; Found != Entries+EntryCount && Found->Hash == Wanted; ++Found)
+		if (Found->NameLength == Name.size() && memcmp(Names+Found->NameOffset, Name.data(), Name.size()) == 0)
+			return Found;
+	return nullptr;
+}
+
+const char *terra::PackFile::GetData(const terra::PackFile::Entry &Found) const{
+	return File.GetData()+Found.Offset;
+}
+
+uint64_t terra::PackFile::Hash(const std::string &Name){
+	return terra::HashData(Name.data(), Name.size());
+}
+
+bool terra::PackFile::Open(const std::string &Filename, std::string &Problem){
+	Entries = nullptr;
+	EntryCount = 0;
+	Names = nullptr;
+	if (!File.Open(Filename)){
+		Problem = "unable to open the file";
+		return false;
+	}
+
+	// Check the header before trusting any of the counts in it
+	const Header *Head = reinterpret_cast<const Header *>(File.GetData());
+	if (File.GetSize() < sizeof(Header) || memcmp(Head->Magic, Magic, sizeof(Magic)) != 0){
+		Problem = "the file is not a pack";
+		File.Close();
+		return false;
+	}
+	if (Head->ByteOrder != ByteOrder || Head->Version != Version){
+		Problem = "the pack was made for another version or machine";
+		File.Close();
+		return false;
+	}
+	uint64_t NamesOffset = sizeof(Header)+uint64_t(Head->EntryCount)*sizeof(Entry);
+	if (NamesOffset+Head->NamesSize > File.GetSize()){
+		Problem = "the index is damaged";
+		File.Close();
+		return false;
+	}
+
+	// Every entry has to point inside the pack, and they have to be sorted for the binary search
+	const Entry *Index = reinterpret_cast<const Entry *>(Head+1);
+	for (uint32_t i = 0; i < Head->EntryCount; ++i)
+		if (uint64_t(Index[i].NameOffset)+Index[i].NameLength > Head->NamesSize || Index[i].Offset > File.GetSize() || Index[i].StoredSize > File.GetSize()-Index[i].Offset || (!Index[i].Compressed && Index[i].StoredSize != Index[i].Size) || (i > 0 && Index[i].Hash < Index[i-1].Hash)){
+			Problem = "the index is damaged";
+			File.Close();
+			return false;
+		}
+	Entries = Index;
+	EntryCount = Head->EntryCount;
+	Names = File.GetData()+NamesOffset;
+	return true;
+}
+
+bool terra::PackFile::Write(const std::string &Filename, const std::vector<std::string> &Files, bool Compress, std::string &Problem){
+	std::ofstream Pack(Filename.c_str(), std::ios::binary);
+	if (!Pack){
+		Problem = "unable to create the pack";
+		return false;
+	}
+
+	// The names come right after the index, so the files start once both are written
+	std::vector<Entry> Index(Files.size());
+	std::string AllNames;
+	for (unsigned int i = 0; i < Files.size(); ++i){
+		Index[i].Hash = Hash(Files[i]);
+		Index[i].NameOffset = AllNames.size();
+		Index[i].NameLength = Files[i].size();
+		Index[i].Compressed = 0;
+		Index[i].Reserved = 0;
+		AllNames += Files[i];
+	}
+	uint64_t Offset = Align(sizeof(Header)+Index.size()*sizeof(Entry)+AllNames.size());
+
+	// Write each file, aligned, compressing it if that makes it smaller
+	std::vector<char> Contents;
+	std::vector<char> Compressed;
+	const char Padding[Alignment] = {0};
+	Pack.seekp(Offset);
+	for (unsigned int i = 0; i < Files.size(); ++i){
+		std::ifstream Source(Files[i].c_str(), std::ios::binary);
+		if (!Source){
+			Problem = std::string("unable to open \"") + Files[i] + "\"";
+			return false;
+		}
+		Source.seekg(0, std::ios::end);
+		Contents.resize(Source.tellg());
+		Source.seekg(0, std::ios::beg);
+		if (!Contents.empty() && !Source.read(&Contents[0], Contents.size())){
+			Problem = std::string("unable to read \"") + Files[i] + "\"";
+			return false;
+		}
+		const std::vector<char> *Stored = &Contents;
+		if (Compress && !Contents.empty()){
+			uLongf CompressedSize = compressBound(Contents.size());
+			Compressed.resize(CompressedSize);
+			if (compress2(reinterpret_cast<Bytef *>(&Compressed[0]), &CompressedSize, reinterpret_cast<const Bytef *>(&Contents[0]), Contents.size(), Z_BEST_COMPRESSION) == Z_OK && CompressedSize < Contents.size()){
+				Compressed.resize(CompressedSize);
+				Stored = &Compressed;
+				Index[i].Compressed = 1;
+			}
+		}
+		Index[i].Offset = Offset;
+		Index[i].Size = Contents.size();
+		Index[i].StoredSize = Stored->size();
+		if (!Stored->empty())
+			Pack.write(&(*Stored)[0], Stored->size());
+		Offset += Stored->size();
+		Pack.write(Padding, Align(Offset)-Offset);
+		Offset = Align(Offset);
+	}
+
+	// Sort the index by hash, then write it and the names in front of the files
+	std::sort(Index.begin(), Index.end(), [](const Entry &Left, const Entry &Right){ return Left.Hash < Right.Hash; });
+	Header Head;
+	memcpy(Head.Magic, Magic, sizeof(Magic));
+	Head.ByteOrder = ByteOrder;
+	Head.Version = Version;
+	Head.EntryCount = Index.size();
+	Head.NamesSize = AllNames.size();
+	Head.Reserved = 0;
+	Pack.seekp(0);
+	Pack.write(reinterpret_cast<const char *>(&Head), sizeof(Head));
+	if (!Index.empty())
+		Pack.write(reinterpret_cast<const char *>(&Index[0]), Index.size()*sizeof(Entry));
+	Pack.write(AllNames.data(), AllNames.size());
+	if (!Pack.good()){
+		Problem = "unable to write the pack";
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,131 @@
+#ifndef TERRA_PACKFILE_HPP
+#define TERRA_PACKFILE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.hpp"
+
+namespace terra{
+	/*!
+	 * \brief Asset pack
+	 *
+	 * A single file holding many others, made by terra_pack. It starts with an index of every file sorted by the hash of its name, followed by the names, then the files themselves, each aligned to 64 bytes. Files can be stored compressed with zlib.
+	 *
+	 * The pack is memory mapped when it is opened, so finding a file is a binary search of the index, and files that aren't compressed can be used straight out of the mapping without being copied.
+	 */
+	class PackFile{
+		public:
+			/*!
+			 * \brief Pack Entry
+			 *
+			 * The index entry of a single file in a pack.
+			 */
+			struct Entry{
+				/*!
+				 * The hash of the file's name.
+				 */
+				uint64_t Hash;
+
+				/*!
+				 * Where the file's data starts in the pack.
+				 */
+				uint64_t Offset;
+
+				/*!
+				 * The size of the file.
+				 */
+				uint64_t Size;
+
+				/*!
+				 * The size of the file's data as it is stored, which is smaller than the file if it is compressed.
+				 */
+				uint64_t StoredSize;
+
+				/*!
+				 * Where the file's name starts in the pack's names.
+				 */
+				uint32_t NameOffset;
+
+				/*!
+				 * The length of the file's name.
+				 */
+				uint32_t NameLength;
+
+				/*!
+				 * Is the file compressed?
+				 */
+				uint32_t Compressed;
+
+				/*!
+				 * Unused, keeps the entries 8 byte aligned.
+				 */
+				uint32_t Reserved;
+			};
+		private:
+			const Entry *Entries;
+			unsigned int EntryCount;
+			MappedFile File;
+			const char *Names;
+			static uint64_t Hash(const std::string &Name);
+			PackFile(const PackFile &Copy);
+			PackFile &operator=(const PackFile &Copy);
+		public:
+			/*!
+			 * The version of the format that is written, and the only one that is read.
+			 */
+			static const unsigned int Version = 1;
+
+			/*!
+			 * Create a new pack with no file open.
+			 */
+			PackFile();
+
+			/*!
+			 * \param Found The entry of the file
+			 * \param Contents Set to the contents of the file, followed by a null character
+			 * \return True if the file could be read, false if it is damaged
+			 *
+			 * Copy a file out of the pack, decompressing it if needed.
+			 */
+			bool Extract(const Entry &Found, std::vector<char> &Contents) const;
+
+			/*!
+			 * \param Name The name of the file
+			 * \return The file's entry, or a null pointer if the pack doesn't have the file
+			 *
+			 * Find a file in the pack.
+			 */
+			const Entry *Find(const std::string &Name) const;
+
+			/*!
+			 * \param Found The entry of the file
+			 * \return A pointer to the file's data, as it is stored, inside the mapping
+			 *
+			 * Retrieve a file's data without copying it. The data is only the file itself if the file isn't compressed.
+			 */
+			const char *GetData(const Entry &Found) const;
+
+			/*!
+			 * \param Filename The filename of the pack
+			 * \param Problem Set to a description of what went wrong if the pack can't be opened
+			 * \return True if the pack was opened, false otherwise
+			 *
+			 * Map a pack into memory and check its index.
+			 */
+			bool Open(const std::string &Filename, std::string &Problem);
+
+			/*!
+			 * \param Filename The filename to write the pack to
+			 * \param Files The names of the files to pack, which they will be found under
+			 * \param Compress Should files be compressed when it makes them smaller?
+			 * \param Problem Set to a description of what went wrong if the pack can't be written
+			 * \return True if the pack was written, false otherwise
+			 *
+			 * Write a new pack holding the given files.
+			 */
+			static bool Write(const std::string &Filename, const std::vector<std::string> &Files, bool Compress, std::string &Problem);
+	};
+}
+
+#endif
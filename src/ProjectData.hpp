@@ -0,0 +1,56 @@
+#ifndef TERRA_PROJECTDATA_HPP
+#define TERRA_PROJECTDATA_HPP
+
+#include <map>
+#include <SFML/System.hpp>
+#include <string>
+#include <vector>
+#include "OgmoObject.hpp"
+#include "OgmoTileset.hpp"
+#include "ProjectLayerData.hpp"
+
+namespace terra{
+	/*!
+	 * \brief Project Data
+	 *
+	 * A structure containing everything that has been extracted from the project file, either the Ogmo XML or its compiled form, before it is handed to the engine.
+	 */
+	struct ProjectData{
+		/*!
+		 * The directory that the project's images are relative to.
+		 */
+		std::string WorkingDirectory;
+
+		/*!
+		 * The default values of every level.
+		 */
+		std::map<std::string, std::string> LevelValues;
+
+		/*!
+		 * The types of the level values.
+		 */
+		std::map<std::string, std::string> LevelValueTypes;
+
+		/*!
+		 * The tilesets, by name.
+		 */
+		std::map<std::string, OgmoTileset> Tilesets;
+
+		/*!
+		 * The size of each tileset's image when the project was parsed, by filename. Tile animations given as ids depend on it.
+		 */
+		std::map<std::string, sf::Vector2<unsigned int>> TilesetSizes;
+
+		/*!
+		 * The object definitions with their default values, by name, whether or not the game has registered them.
+		 */
+		std::map<std::string, OgmoObject> Objects;
+
+		/*!
+		 * The layers, in drawing order.
+		 */
+		std::vector<ProjectLayerData> Layers;
+	};
+}
+
+#endif
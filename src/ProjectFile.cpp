@@ -0,0 +1,277 @@
+#include <cstring>
+#include <fstream>
+#include "ProjectFile.hpp"
+
+namespace{
+	// The header is followed by the project, written out field by field in the order Write() visits it
+	struct Header{
+		char Magic[4];
+		uint32_t ByteOrder;
+		uint32_t Version;
+		uint32_t Reserved;
+		uint64_t SourceHash;
+	};
+	const char Magic[4] = {'T', 'P', 'R', 'J'};
+	const uint32_t ByteOrder = 0x01020304;
+
+	// Appends fields to the compiled project
+	class Writer{
+		public:
+			std::string Bytes;
+			void Float(float Value){
+				Bytes.append(reinterpret_cast<const char *>(&Value), sizeof(Value));
+			}
+			void Integer(uint32_t Value){
+				Bytes.append(reinterpret_cast<const char *>(&Value), sizeof(Value));
+			}
+			void String(const std::string &Value){
+				Integer(Value.size());
+				Bytes += Value;
+			}
+			void Strings(const std::map<std::string, std::string> &Values){
+				Integer(Values.size());
+				for (auto i = Values.begin(); i != Values.end(); ++i){
+					String(i->first);
+					String(i->second);
+				}
+			}
+	};
+
+	// Takes fields back out of the compiled project, failing instead of reading past its end
+	class Reader{
+		private:
+			const char *Position;
+			const char *End;
+			bool Failed;
+			bool Take(void *Value, unsigned long Size){
+				if (Failed || static_cast<unsigned long>(End-Position) < Size){
+					Failed = true;
+					return false;
+				}
+				memcpy(Value, Position, Size);
+				Position += Size;
+				return true;
+			}
+		public:
+			Reader(const char *Data, unsigned long Size){
+				Position = Data;
+				End = Data+Size;
+				Failed = false;
+			}
+			// Counts are checked against what's left, so a damaged count can't make anything huge
+			uint32_t Count(unsigned long ElementSize){
+				uint32_t Value = Integer();
+				if (uint64_t(Value)*ElementSize > static_cast<unsigned long>(End-Position)){
+					Failed = true;
+					return 0;
+				}
+				return Value;
+			}
+			bool IsDone() const{
+				return !Failed && Position == End;
+			}
+			float Float(){
+				float Value = 0;
+				Take(&Value, sizeof(Value));
+				return Value;
+			}
+			uint32_t Integer(){
+				uint32_t Value = 0;
+				Take(&Value, sizeof(Value));
+				return Value;
+			}
+			std::string String(){
+				uint32_t Size = Count(1);
+				std::string Value(Position, Failed ? 0 : Size);
+				if (!Failed)
+					Position += Size;
+				return Value;
+			}
+			void Strings(std::map<std::string, std::string> &Values){
+				for (uint32_t i = Count(2*sizeof(uint32_t)); i > 0; --i){
+					std::string Name = String();
+					Values[Name] = String();
+				}
+			}
+	};
+}
+
+std::string terra::ProjectFile::GetCompiledName(const std::string &Filename){
+	return Filename+"c";
+}
+
+bool terra::ProjectFile::Read(const char *Data, unsigned long Size, uint64_t SourceHash, terra::ProjectData &Project, std::string &Problem){
+	// Check the header first
+	Header Head;
+	if (Size < sizeof(Header)){
+		Problem = "the file is too small";
+		return false;
+	}
+	memcpy(&Head, Data, sizeof(Head));
+	if (memcmp(Head.Magic, Magic, sizeof(Magic)) != 0){
+		Problem = "the file is not a compiled project";
+		return false;
+	}
+	if (Head.ByteOrder != ByteOrder || Head.Version != Version){
+		Problem = "the file was compiled for another version or machine";
+		return false;
+	}
+	if (Head.SourceHash != SourceHash){
+		Problem = "the project file has changed";
+		return false;
+	}
+
+	// Settings and level values
+	Reader In(Data+sizeof(Header), Size-sizeof(Header));
+	Project.WorkingDirectory = In.String();
+	In.Strings(Project.LevelValues);
+	In.Strings(Project.LevelValueTypes);
+
+	// Tilesets
+	for (uint32_t i = In.Count(6*sizeof(uint32_t)); i > 0; --i){
+		terra::OgmoTileset &Tileset = Project.Tilesets[In.String()];
+		Tileset.Image = In.String();
+		Tileset.TileWidth = In.Integer();
+		Tileset.TileHeight = In.Integer();
+		sf::Vector2<unsigned int> &ImageSize = Project.TilesetSizes[Tileset.Image];
+		ImageSize.x = In.Integer();
+		ImageSize.y = In.Integer();
+		Tileset.Animations.resize(In.Count(3*sizeof(uint32_t)));
+		for (auto j = Tileset.Animations.begin(); j != Tileset.Animations.end(); ++j){
+			j->Length = In.Float();
+			j->Frame = In.Integer();
+			j->Frames.resize(In.Count(3*sizeof(uint32_t)));
+			j->Durations.resize(j->Frames.size());
+			for (unsigned int k = 0; k < j->Frames.size(); ++k){
+				j->Frames[k].x = In.Integer();
+				j->Frames[k].y = In.Integer();
+				j->Durations[k] = In.Float();
+			}
+		}
+	}
+
+	// Object definitions
+	for (uint32_t i = In.Count(11*sizeof(uint32_t)); i > 0; --i){
+		std::string Name = In.String();
+		terra::OgmoObject &Object = Project.Objects[Name];
+		Object.Name = Name;
+		Object.Image = In.String();
+		In.Strings(Object.Values);
+		In.Strings(Object.ValueTypes);
+		Object.Nodes.resize(In.Count(2*sizeof(float)));
+		for (auto j = Object.Nodes.begin(); j != Object.Nodes.end(); ++j){
+			j->x = In.Float();
+			j->y = In.Float();
+		}
+		Object.ResizableX = In.Integer() != 0;
+		Object.ResizableY = In.Integer() != 0;
+		Object.Position.x = In.Float();
+		Object.Position.y = In.Float();
+		Object.Size.x = In.Integer();
+		Object.Size.y = In.Integer();
+	}
+
+	// Layer definitions
+	Project.Layers.resize(In.Count(8*sizeof(uint32_t)));
+	for (auto i = Project.Layers.begin(); i != Project.Layers.end(); ++i){
+		i->Name = In.String();
+		uint32_t Type = In.Integer();
+		i->Type = Type == terra::Item::Tile ? terra::Item::Tile : (Type == terra::Item::Grid ? terra::Item::Grid : terra::Item::Object);
+		i->TileLayer.MultipleTilesets = In.Integer() != 0;
+		i->TileLayer.ExportTileSize = In.Integer() != 0;
+		i->TileLayer.ExportTileIDs = In.Integer() != 0;
+		i->GridLayer.CellSize.x = In.Integer();
+		i->GridLayer.CellSize.y = In.Integer();
+		i->GridLayer.RowEnd = In.Integer();
+	}
+	if (!In.IsDone()){
+		Problem = "the file is damaged";
+		Project = terra::ProjectData();
+		return false;
+	}
+	return true;
+}
+
+bool terra::ProjectFile::Write(const std::string &Filename, uint64_t SourceHash, const terra::ProjectData &Project, std::string &Problem){
+	// Settings and level values
+	Writer Out;
+	Out.String(Project.WorkingDirectory);
+	Out.Strings(Project.LevelValues);
+	Out.Strings(Project.LevelValueTypes);
+
+	// Tilesets
+	Out.Integer(Project.Tilesets.size());
+	for (auto i = Project.Tilesets.begin(); i != Project.Tilesets.end(); ++i){
+		auto ImageSize = Project.TilesetSizes.find(i->second.Image);
+		Out.String(i->first);
+		Out.String(i->second.Image);
+		Out.Integer(i->second.TileWidth);
+		Out.Integer(i->second.TileHeight);
+		Out.Integer(ImageSize != Project.TilesetSizes.end() ? ImageSize->second.x : 0);
+		Out.Integer(ImageSize != Project.TilesetSizes.end() ? ImageSize->second.y : 0);
+		Out.Integer(i->second.Animations.size());
+		for (auto j = i->second.Animations.begin(); j != i->second.Animations.end(); ++j){
+			Out.Float(j->Length);
+			Out.Integer(j->Frame);
+			Out.Integer(j->Frames.size());
+			for (unsigned int k = 0; k < j->Frames.size(); ++k){
+				Out.Integer(j->Frames[k].x);
+				Out.Integer(j->Frames[k].y);
+				Out.Float(k < j->Durations.size() ? j->Durations[k] : 0.f);
+			}
+		}
+	}
+
+	// Object definitions
+	Out.Integer(Project.Objects.size());
+	for (auto i = Project.Objects.begin(); i != Project.Objects.end(); ++i){
+		Out.String(i->first);
+		Out.String(i->second.Image);
+		Out.Strings(i->second.Values);
+		Out.Strings(i->second.ValueTypes);
+		Out.Integer(i->second.Nodes.size());
+		for (auto j = i->second.Nodes.begin(); j != i->second.Nodes.end(); ++j){
+			Out.Float(j->x);
+			Out.Float(j->y);
+		}
+		Out.Integer(i->second.ResizableX);
+		Out.Integer(i->second.ResizableY);
+		Out.Float(i->second.Position.x);
+		Out.Float(i->second.Position.y);
+		Out.Integer(i->second.Size.x);
+		Out.Integer(i->second.Size.y);
+	}
+
+	// Layer definitions
+	Out.Integer(Project.Layers.size());
+	for (auto i = Project.Layers.begin(); i != Project.Layers.end(); ++i){
+		Out.String(i->Name);
+		Out.Integer(i->Type);
+		Out.Integer(i->TileLayer.MultipleTilesets);
+		Out.Integer(i->TileLayer.ExportTileSize);
+		Out.Integer(i->TileLayer.ExportTileIDs);
+		Out.Integer(i->GridLayer.CellSize.x);
+		Out.Integer(i->GridLayer.CellSize.y);
+		Out.Integer(i->GridLayer.RowEnd);
+	}
+
+	// Write it all out
+	Header Head;
+	memcpy(Head.Magic, Magic, sizeof(Magic));
+	Head.ByteOrder = ByteOrder;
+	Head.Version = Version;
+	Head.Reserved = 0;
+	Head.SourceHash = SourceHash;
+	std::ofstream File(Filename.c_str(), std::ios::binary);
+	if (!File){
+		Problem = "unable to create the file";
+		return false;
+	}
+	File.write(reinterpret_cast<const char *>(&Head), sizeof(Head));
+	File.write(Out.Bytes.data(), Out.Bytes.size());
+	if (!File.good()){
+		Problem = "unable to write the file";
+		return false;
+	}
+	return true;
+}
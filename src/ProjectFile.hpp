@@ -0,0 +1,54 @@
+#ifndef TERRA_PROJECTFILE_HPP
+#define TERRA_PROJECTFILE_HPP
+
+#include <cstdint>
+#include <string>
+#include "ProjectData.hpp"
+
+namespace terra{
+	/*!
+	 * \brief Compiled project files
+	 *
+	 * Reads and writes the compiled form of the Ogmo project, which terra_levelc writes next to the project file so the game doesn't have to parse the XML when it starts. A compiled project is a small header holding the hash of the project file it was made from, followed by the tilesets, object definitions, and layer definitions written out one after another.
+	 */
+	class ProjectFile{
+		public:
+			/*!
+			 * The version of the format that is written, and the only one that is read.
+			 */
+			static const unsigned int Version = 1;
+
+			/*!
+			 * \param Filename The filename of the Ogmo project
+			 * \return The filename of the project's compiled form
+			 *
+			 * Find where the compiled form of a project is kept, which is next to the project with a "c" on the end of its extension.
+			 */
+			static std::string GetCompiledName(const std::string &Filename);
+
+			/*!
+			 * \param Data The contents of a compiled project
+			 * \param Size The size of the contents
+			 * \param SourceHash The hash of the project file, as given by HashData()
+			 * \param Project The project data to fill in
+			 * \param Problem Set to a description of what went wrong if the project can't be read
+			 * \return True if the project was read, false if it was compiled from another project file, is from another version, or is damaged
+			 *
+			 * Read a compiled project, such as one that has been memory mapped.
+			 */
+			static bool Read(const char *Data, unsigned long Size, uint64_t SourceHash, ProjectData &Project, std::string &Problem);
+
+			/*!
+			 * \param Filename The filename to write the compiled project to
+			 * \param SourceHash The hash of the project file, as given by HashData()
+			 * \param Project The project data to write
+			 * \param Problem Set to a description of what went wrong if the project can't be written
+			 * \return True if the project was written, false otherwise
+			 *
+			 * Write a compiled project.
+			 */
+			static bool Write(const std::string &Filename, uint64_t SourceHash, const ProjectData &Project, std::string &Problem);
+	};
+}
+
+#endif
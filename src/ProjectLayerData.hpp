@@ -0,0 +1,38 @@
+#ifndef TERRA_PROJECTLAYERDATA_HPP
+#define TERRA_PROJECTLAYERDATA_HPP
+
+#include <string>
+#include "Item.hpp"
+#include "OgmoGridLayer.hpp"
+#include "OgmoTileLayer.hpp"
+
+namespace terra{
+	/*!
+	 * \brief Project Layer Data
+	 *
+	 * A structure containing the definition of one layer of the project.
+	 */
+	struct ProjectLayerData{
+		/*!
+		 * The name of the layer.
+		 */
+		std::string Name;
+
+		/*!
+		 * The type of item the layer holds.
+		 */
+		Item::ItemType Type;
+
+		/*!
+		 * The definition of the layer, if it is a tile layer.
+		 */
+		OgmoTileLayer TileLayer;
+
+		/*!
+		 * The definition of the layer, if it is a grid layer.
+		 */
+		OgmoGridLayer GridLayer;
+	};
+}
+
+#endif
@@ -0,0 +1,27 @@
+#include "RenderBackend.hpp"
+
+terra::RenderBackend::RenderBackend(){
+	Stats = nullptr;
+	LastTexture = nullptr;
+}
+
+void terra::RenderBackend::Count(const sf::Image *Texture, unsigned int VertexCount, bool NewDrawCall){
+	if (!Stats)
+		return;
+	if (NewDrawCall)
+		++Stats->DrawCalls;
+	if (Texture != LastTexture){
+		++Stats->TextureBinds;
+		LastTexture = Texture;
+	}
+	Stats->Vertices += VertexCount;
+}
+
+void terra::RenderBackend::SetStats(terra::RenderStats *NewStats){
+	// Whatever was bound before isn't known to be bound any more, so the first texture drawn always counts
+	Stats = NewStats;
+	LastTexture = nullptr;
+}
+
+terra::RenderBackend::~RenderBackend(){
+}
@@ -0,0 +1,92 @@
+#ifndef TERRA_RENDERBACKEND_HPP
+#define TERRA_RENDERBACKEND_HPP
+
+#include <SFML/Graphics.hpp>
+#include "RenderStats.hpp"
+#include "Vertex.hpp"
+
+namespace terra{
+	/*!
+	 * \brief A render backend
+	 *
+	 * Something that the engine's batched geometry can be drawn onto. Everything the engine draws itself (tiles, batched sprites, the console) goes through a backend, so the same scene can be drawn onto a window or onto an image in memory.
+	 */
+	class RenderBackend{
+		private:
+			RenderStats *Stats;
+			const sf::Image *LastTexture;
+		protected:
+			/*!
+			 * \param Texture The texture of the batch
+			 * \param VertexCount The number of vertices in the batch
+			 * \param NewDrawCall True if the batch is drawn on its own, false if it gets merged into the previous one
+			 *
+			 * Count a batch of quads towards the statistics being collected, if any. Backends call this from DrawQuads.
+			 */
+			void Count(const sf::Image *Texture, unsigned int VertexCount, bool NewDrawCall = true);
+		public:
+			/*!
+			 * Create a new backend which doesn't collect statistics.
+			 */
+			RenderBackend();
+
+			/*!
+			 * \param Color The color to clear to
+			 *
+			 * Clear the whole backend to a single color.
+			 */
+			virtual void Clear(const sf::Color &Color = sf::Color::Black) = 0;
+
+			/*!
+			 * \param Texture The texture to draw from, or a null pointer to draw plain colored quads
+			 * \param Vertices An array of vertices, four per quad, in top left, bottom left, bottom right, top right order
+			 * \param VertexCount The number of vertices in the array
+			 * \param Blend The blend mode to draw with
+			 *
+			 * Draw a list of quads.
+			 */
+			virtual void DrawQuads(const sf::Image *Texture, const Vertex *Vertices, unsigned int VertexCount, sf::Blend::Mode Blend = sf::Blend::Alpha) = 0;
+
+			/*!
+			 * \return A target for items that draw SFML drawables themselves
+			 *
+			 * Retrieve the SFML target that items should draw onto in OnRender. Backends that can't draw SFML drawables give a target which ignores them.
+			 */
+			virtual sf::RenderTarget &GetTarget() = 0;
+
+			/*!
+			 * \return The current view
+			 *
+			 * Retrieve the view that the backend is drawing through.
+			 */
+			virtual const sf::View &GetView() const = 0;
+
+			/*!
+			 * \return True if the backend draws with the graphics card, false otherwise
+			 *
+			 * Determines if the backend can draw images that only live on the graphics card, such as the contents of an sf::RenderImage.
+			 */
+			virtual const bool IsHardware() const = 0;
+
+			/*!
+			 * \param NewStats The statistics to count draw calls, texture binds, and vertices into, or a null pointer to stop counting
+			 *
+			 * Change where the backend counts what is drawn onto it. The first texture drawn after this always counts as a bind.
+			 */
+			void SetStats(RenderStats *NewStats);
+
+			/*!
+			 * \param View The new view
+			 *
+			 * Change the view that the backend draws through.
+			 */
+			virtual void SetView(const sf::View &View) = 0;
+
+			/*!
+			 * Destroy the backend.
+			 */
+			virtual ~RenderBackend();
+	};
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef TERRA_RENDERSTATS_HPP
+#define TERRA_RENDERSTATS_HPP
+
+namespace terra{
+	/*!
+	 * \brief Render Statistics
+	 *
+	 * A structure containing counters which are collected while a frame is rendered.
+	 */
+	struct RenderStats{
+		/*!
+		 * The number of items that were considered for rendering.
+		 */
+		unsigned int Submitted;
+
+		/*!
+		 * The number of items that were skipped because they were outside of the view.
+		 */
+		unsigned int Culled;
+
+		/*!
+		 * The number of items that were drawn.
+		 */
+		unsigned int Drawn;
+
+		/*!
+		 * The number of batches of quads that were sent to the backend.
+		 */
+		unsigned int DrawCalls;
+
+		/*!
+		 * The number of times a batch used a different texture than the batch before it.
+		 */
+		unsigned int TextureBinds;
+
+		/*!
+		 * The number of vertices that were sent to the backend.
+		 */
+		unsigned int Vertices;
+
+		/*!
+		 * Create a new set of statistics with every counter at zero.
+		 */
+		RenderStats() : Submitted(0), Culled(0), Drawn(0), DrawCalls(0), TextureBinds(0), Vertices(0){
+		}
+
+		/*!
+		 * \param Other The statistics to add
+		 * \return A reference to these statistics
+		 *
+		 * Add another set of statistics to these ones, counter by counter.
+		 */
+		RenderStats &operator+=(const RenderStats &Other){
+			Submitted += Other.Submitted;
+			Culled += Other.Culled;
+			Drawn += Other.Drawn;
+			DrawCalls += Other.DrawCalls;
+			TextureBinds += Other.TextureBinds;
+			Vertices += Other.Vertices;
+			return *this;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,70 @@
+#include "RenderThread.hpp"
+
+void terra::RenderThread::Run(terra::RenderThread *Renderer){
+	std::unique_lock<std::mutex> Lock(Renderer->Guard);
+	while (true){
+		// Sleep until there is a frame to pick up, or the thread is stopped
+		Renderer->Changed.wait(Lock, [Renderer](){
+			return Renderer->Pending >= 0 || !Renderer->Running;
+		});
+		if (!Renderer->Running)
+			return;
+		int Index = Renderer->Pending;
+		Renderer->Pending = -1;
+		Renderer->Busy = true;
+
+		// Draw it outside the lock, then let go of the window so the game thread can use it in between frames
+		Lock.unlock();
+		Renderer->Window.SetActive(true);
+		Renderer->Lists[Index].Replay(Renderer->Backend);
+		Renderer->Window.Display();
+		Renderer->Window.SetActive(false);
+		Lock.lock();
+		Renderer->Busy = false;
+		Renderer->Changed.notify_all();
+	}
+}
+
+terra::RenderThread::RenderThread(sf::RenderWindow &NewWindow) : Window(NewWindow), Backend(NewWindow){
+	Recording = 0;
+	Pending = -1;
+	Busy = false;
+	Running = true;
+
+	// The window's context can only be active in one thread at a time
+	Window.SetActive(false);
+	Thread = std::thread(&terra::RenderThread::Run, this);
+}
+
+terra::CommandList &terra::RenderThread::Begin(){
+	Lists[Recording].Reset(Window.GetWidth(), Window.GetHeight());
+	Lists[Recording].SetView(Window.GetView());
+	return Lists[Recording];
+}
+
+void terra::RenderThread::Submit(){
+	// The other list is free once the previous frame is done
+	Wait();
+	Window.SetActive(false);
+	std::lock_guard<std::mutex> Lock(Guard);
+	Pending = Recording;
+	Recording = 1-Recording;
+	Changed.notify_all();
+}
+
+void terra::RenderThread::Wait(){
+	std::unique_lock<std::mutex> Lock(Guard);
+	Changed.wait(Lock, [this](){
+		return Pending < 0 && !Busy;
+	});
+}
+
+terra::RenderThread::~RenderThread(){
+	Wait();
+	{
+		std::lock_guard<std::mutex> Lock(Guard);
+		Running = false;
+		Changed.notify_all();
+	}
+	Thread.join();
+}
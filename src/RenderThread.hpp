@@ -0,0 +1,66 @@
+#ifndef TERRA_RENDERTHREAD_HPP
+#define TERRA_RENDERTHREAD_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <SFML/Graphics.hpp>
+#include <thread>
+#include "CommandList.hpp"
+#include "TargetBackend.hpp"
+
+namespace terra{
+	/*!
+	 * \brief A dedicated render thread
+	 *
+	 * A thread which owns drawing to the game window. The game thread records each frame into a command list and submits it, and the render thread replays it onto the window while the game thread moves on to the next frame. Two lists are kept, so the game thread is never more than one frame ahead.
+	 *
+	 * The game thread must call Wait() before drawing to the window itself, or before destroying anything that a submitted frame might still point to.
+	 */
+	class RenderThread{
+		private:
+			sf::RenderWindow &Window;
+			TargetBackend Backend;
+			CommandList Lists[2];
+			unsigned int Recording;
+			int Pending;
+			bool Busy;
+			bool Running;
+			std::condition_variable Changed;
+			std::mutex Guard;
+			std::thread Thread;
+			static void Run(RenderThread *Renderer);
+			RenderThread(const RenderThread &Copy);
+			RenderThread &operator=(const RenderThread &Copy);
+		public:
+			/*!
+			 * \param NewWindow The window to draw onto, which must outlive the render thread
+			 *
+			 * Create a new render thread and start it.
+			 */
+			RenderThread(sf::RenderWindow &NewWindow);
+
+			/*!
+			 * \return The command list to record the next frame into
+			 *
+			 * Start recording a new frame. The list starts out with the window's current view.
+			 */
+			CommandList &Begin();
+
+			/*!
+			 * Hand the recorded frame over to the render thread. Waits for the previous frame to be finished first.
+			 */
+			void Submit();
+
+			/*!
+			 * Wait until every submitted frame has been drawn and displayed.
+			 */
+			void Wait();
+
+			/*!
+			 * Finish drawing every submitted frame, then stop the render thread.
+			 */
+			~RenderThread();
+	};
+}
+
+#endif
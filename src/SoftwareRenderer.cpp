@@ -0,0 +1,391 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include "SoftwareRenderer.hpp"
+#include "Utilities.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TERRA_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace{
+	// Pixels are kept as RGBA bytes, so pack colors in memory order
+	sf::Uint32 Pack(const sf::Color &Color){
+		sf::Uint8 Bytes[4] = {Color.r, Color.g, Color.b, Color.a};
+		sf::Uint32 Packed;
+		std::memcpy(&Packed, Bytes, 4);
+		return Packed;
+	}
+
+	// Divide by 255, rounded, without dividing
+	unsigned int Div255(unsigned int X){
+		X += 128;
+		return (X+(X>>8))>>8;
+	}
+
+	// Quads come in top left, bottom left, bottom right, top right order, so the corners have to share their sides' coordinates
+	bool IsAxisAligned(const terra::Vertex *Corners){
+		const float Tolerance = 0.01;
+		return std::fabs(Corners[0].Position.x-Corners[1].Position.x) < Tolerance && std::fabs(Corners[1].Position.y-Corners[2].Position.y) < Tolerance && std::fabs(Corners[2].Position.x-Corners[3].Position.x) < Tolerance && std::fabs(Corners[3].Position.y-Corners[0].Position.y) < Tolerance;
+	}
+
+	void FillSpan(sf::Uint32 *Destination, sf::Uint32 Color, unsigned int Count){
+		unsigned int i = 0;
+#ifdef TERRA_SSE2
+		__m128i Fill = _mm_set1_epi32(Color);
+		for (; i+4 <= Count; i += 4)
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(Destination+i), Fill);
+#endif
+		for (; i < Count; ++i)
+			Destination[i] = Color;
+	}
+
+	void ModulateSpan(sf::Uint32 *Span, sf::Uint32 Color, unsigned int Count){
+		const sf::Uint8 *Tint = reinterpret_cast<const sf::Uint8 *>(&Color);
+		for (unsigned int i = 0; i < Count; ++i){
+			sf::Uint8 *Pixel = reinterpret_cast<sf::Uint8 *>(Span+i);
+			for (unsigned int j = 0; j < 4; ++j)
+				Pixel[j] = Div255(Pixel[j]*Tint[j]);
+		}
+	}
+
+#ifdef TERRA_SSE2
+	// Divide eight 16 bit values by 255 at once
+	__m128i Div255(__m128i X){
+		X = _mm_add_epi16(X, _mm_set1_epi16(128));
+		return _mm_srli_epi16(_mm_add_epi16(X, _mm_srli_epi16(X, 8)), 8);
+	}
+
+	// Copy each pixel's alpha into all four of its channels
+	__m128i BroadcastAlpha(__m128i X){
+		return _mm_shufflehi_epi16(_mm_shufflelo_epi16(X, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	}
+#endif
+
+	// Blend a span of pixels the same way OpenGL would, with the blend function SFML uses for each mode
+	void BlendSpan(sf::Uint32 *Destination, const sf::Uint32 *Source, unsigned int Count, sf::Blend::Mode Blend){
+		if (Blend == sf::Blend::None){
+			std::memcpy(Destination, Source, Count*4);
+			return;
+		}
+		unsigned int i = 0;
+#ifdef TERRA_SSE2
+		// Four pixels at a time, two per register once widened to 16 bits a channel
+		__m128i Zero = _mm_setzero_si128();
+		__m128i Max = _mm_set1_epi16(255);
+		if (Blend == sf::Blend::Alpha){
+			for (; i+4 <= Count; i += 4){
+				__m128i Src = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Source+i));
+				__m128i Dst = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Destination+i));
+				__m128i SrcLow = _mm_unpacklo_epi8(Src, Zero);
+				__m128i SrcHigh = _mm_unpackhi_epi8(Src, Zero);
+				__m128i AlphaLow = BroadcastAlpha(SrcLow);
+				__m128i AlphaHigh = BroadcastAlpha(SrcHigh);
+				__m128i Low = _mm_add_epi16(_mm_mullo_epi16(SrcLow, AlphaLow), _mm_mullo_epi16(_mm_unpacklo_epi8(Dst, Zero), _mm_sub_epi16(Max, AlphaLow)));
+				__m128i High = _mm_add_epi16(_mm_mullo_epi16(SrcHigh, AlphaHigh), _mm_mullo_epi16(_mm_unpackhi_epi8(Dst, Zero), _mm_sub_epi16(Max, AlphaHigh)));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(Destination+i), _mm_packus_epi16(Div255(Low), Div255(High)));
+			}
+		}
+		else if (Blend == sf::Blend::Add){
+			for (; i+4 <= Count; i += 4){
+				__m128i Src = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Source+i));
+				__m128i Dst = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Destination+i));
+				__m128i SrcLow = _mm_unpacklo_epi8(Src, Zero);
+				__m128i SrcHigh = _mm_unpackhi_epi8(Src, Zero);
+				__m128i Low = Div255(_mm_mullo_epi16(SrcLow, BroadcastAlpha(SrcLow)));
+				__m128i High = Div255(_mm_mullo_epi16(SrcHigh, BroadcastAlpha(SrcHigh)));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(Destination+i), _mm_adds_epu8(Dst, _mm_packus_epi16(Low, High)));
+			}
+		}
+#endif
+
+		// Whatever is left over
+		for (; i < Count; ++i){
+			const sf::Uint8 *Src = reinterpret_cast<const sf::Uint8 *>(Source+i);
+			sf::Uint8 *Dst = reinterpret_cast<sf::Uint8 *>(Destination+i);
+			for (unsigned int j = 0; j < 4; ++j){
+				if (Blend == sf::Blend::Alpha)
+					Dst[j] = Div255(Src[j]*Src[3]+Dst[j]*(255-Src[3]));
+				else if (Blend == sf::Blend::Add)
+					Dst[j] = std::min(255u, Dst[j]+Div255(Src[j]*Src[3]));
+				else
+					Dst[j] = Div255(Dst[j]*Src[j]);
+			}
+		}
+	}
+}
+
+terra::SoftwareRenderer::SoftwareRenderer(unsigned int NewWidth, unsigned int NewHeight, unsigned int NewThreadCount) : Null(NewWidth, NewHeight), Workers(NewThreadCount > 1 ? NewThreadCount-1 : 0){
+	Width = NewWidth;
+	Height = NewHeight;
+	Skipped = 0;
+	ThreadCount = NewThreadCount ? NewThreadCount : 1;
+	Pixels.resize(Width*Height, 0);
+	BinsX = (Width+TileSize-1)/TileSize;
+	BinsY = (Height+TileSize-1)/TileSize;
+	Bins.resize(BinsX*BinsY);
+	SetView(sf::View(sf::FloatRect(0, 0, Width, Height)));
+}
+
+void terra::SoftwareRenderer::Clear(const sf::Color &Color){
+	// Anything queued would be covered anyway
+	Primitives.clear();
+	for (auto i = Bins.begin(); i != Bins.end(); ++i)
+		i->clear();
+	if (!Pixels.empty())
+		FillSpan(&Pixels[0], Pack(Color), Pixels.size());
+}
+
+void terra::SoftwareRenderer::Display(){
+	if (Primitives.empty())
+		return;
+
+	// Hand the tiles out to the threads in an interleaved pattern, so they share busy areas of the screen
+	unsigned int Threads = std::min(ThreadCount, BinsX*BinsY);
+	std::vector<Job> Jobs(Threads);
+	for (unsigned int i = 0; i < Threads; ++i){
+		Jobs[i].Renderer = this;
+		Jobs[i].First = i;
+		if (i){
+			Job *Work = &Jobs[i];
+			Workers.Add([Work](){
+				RunJob(Work);
+			});
+		}
+	}
+
+	// The calling thread takes the first share, then waits for the others
+	RunJob(&Jobs[0]);
+	Workers.Wait();
+
+	// Start the next batch fresh, textures may not outlive it
+	Textures.clear();
+	Primitives.clear();
+	for (auto i = Bins.begin(); i != Bins.end(); ++i)
+		i->clear();
+}
+
+void terra::SoftwareRenderer::DrawQuads(const sf::Image *Texture, const terra::Vertex *Vertices, unsigned int VertexCount, sf::Blend::Mode Blend){
+	Count(Texture, VertexCount);
+
+	// Remember where the texture's pixels are, and how its texture coordinates map onto them
+	const TextureData *Data = nullptr;
+	if (Texture){
+		auto Found = Textures.find(Texture);
+		if (Found == Textures.end()){
+			TextureData NewData;
+			NewData.Pixels = Texture->GetPixelsPtr();
+			NewData.Width = Texture->GetWidth();
+			NewData.Height = Texture->GetHeight();
+			NewData.Coords = Texture->GetTexCoords(sf::IntRect(0, 0, NewData.Width, NewData.Height));
+			Found = Textures.insert(std::pair<const sf::Image *, TextureData>(Texture, NewData)).first;
+		}
+		if (!Found->second.Pixels || !Found->second.Width || !Found->second.Height)
+			return;
+		Data = &Found->second;
+	}
+
+	for (unsigned int i = 0; i+3 < VertexCount; i += 4){
+		// Only quads whose sides line up with the axes can be rasterized from two corners
+		const terra::Vertex &First = Vertices[i];
+		const terra::Vertex &Opposite = Vertices[i+2];
+		if (!IsAxisAligned(&Vertices[i])){
+			++Skipped;
+			continue;
+		}
+
+		// Transform the opposite corners of the quad onto the screen
+		Primitive NewPrimitive;
+		NewPrimitive.Left = First.Position.x*ScaleX+OffsetX;
+		NewPrimitive.Top = First.Position.y*ScaleY+OffsetY;
+		NewPrimitive.Right = Opposite.Position.x*ScaleX+OffsetX;
+		NewPrimitive.Bottom = Opposite.Position.y*ScaleY+OffsetY;
+		NewPrimitive.U0 = NewPrimitive.V0 = NewPrimitive.U1 = NewPrimitive.V1 = 0.;
+		if (Data){
+			NewPrimitive.U0 = (First.TexCoords.x-Data->Coords.Left)/Data->Coords.Width*Data->Width;
+			NewPrimitive.V0 = (First.TexCoords.y-Data->Coords.Top)/Data->Coords.Height*Data->Height;
+			NewPrimitive.U1 = (Opposite.TexCoords.x-Data->Coords.Left)/Data->Coords.Width*Data->Width;
+			NewPrimitive.V1 = (Opposite.TexCoords.y-Data->Coords.Top)/Data->Coords.Height*Data->Height;
+		}
+		NewPrimitive.Texture = Data;
+		NewPrimitive.Color = Pack(First.Color);
+		NewPrimitive.Blend = Blend;
+
+		// Flipped quads are stored the right way round with flipped texture coordinates
+		if (NewPrimitive.Left > NewPrimitive.Right){
+			std::swap(NewPrimitive.Left, NewPrimitive.Right);
+			std::swap(NewPrimitive.U0, NewPrimitive.U1);
+		}
+		if (NewPrimitive.Top > NewPrimitive.Bottom){
+			std::swap(NewPrimitive.Top, NewPrimitive.Bottom);
+			std::swap(NewPrimitive.V0, NewPrimitive.V1);
+		}
+
+		// Find the pixels whose centers it covers, skipping it if there are none
+		int Left = std::max<int>(Clip.Left, std::ceil(NewPrimitive.Left-0.5));
+		int Top = std::max<int>(Clip.Top, std::ceil(NewPrimitive.Top-0.5));
+		int Right = std::min<int>(Clip.Left+Clip.Width, std::ceil(NewPrimitive.Right-0.5));
+		int Bottom = std::min<int>(Clip.Top+Clip.Height, std::ceil(NewPrimitive.Bottom-0.5));
+		if (Left >= Right || Top >= Bottom)
+			continue;
+
+		// Sort it into every tile it touches
+		NewPrimitive.Pixels = sf::IntRect(Left, Top, Right-Left, Bottom-Top);
+		unsigned int Index = Primitives.size();
+		Primitives.push_back(NewPrimitive);
+		for (int y = Top/static_cast<int>(TileSize); y <= (Bottom-1)/static_cast<int>(TileSize); ++y)
+			for (int x = Left/static_cast<int>(TileSize); x <= (Right-1)/static_cast<int>(TileSize); ++x)
+				Bins[y*BinsX+x].push_back(Index);
+	}
+}
+
+unsigned int terra::SoftwareRenderer::GetHeight() const{
+	return Height;
+}
+
+const sf::Uint8 *terra::SoftwareRenderer::GetPixels() const{
+	if (Pixels.empty())
+		return nullptr;
+	return reinterpret_cast<const sf::Uint8 *>(&Pixels[0]);
+}
+
+const unsigned int terra::SoftwareRenderer::GetSkippedCount() const{
+	return Skipped+Null.GetIgnoredCount();
+}
+
+sf::RenderTarget &terra::SoftwareRenderer::GetTarget(){
+	return Null;
+}
+
+const sf::View &terra::SoftwareRenderer::GetView() const{
+	return View;
+}
+
+unsigned int terra::SoftwareRenderer::GetWidth() const{
+	return Width;
+}
+
+const bool terra::SoftwareRenderer::IsHardware() const{
+	return false;
+}
+
+void terra::SoftwareRenderer::RasterizeTile(unsigned int Tile, std::vector<sf::Uint32> &Span){
+	// Work out the tile's pixels
+	int TileLeft = (Tile%BinsX)*TileSize;
+	int TileTop = (Tile/BinsX)*TileSize;
+	int TileRight = std::min<int>(TileLeft+TileSize, Width);
+	int TileBottom = std::min<int>(TileTop+TileSize, Height);
+
+	// Draw each primitive touching the tile in the order they were queued
+	const std::vector<unsigned int> &Bin = Bins[Tile];
+	for (auto i = Bin.begin(); i != Bin.end(); ++i){
+		const Primitive &Current = Primitives[*i];
+		int Left = std::max(TileLeft, Current.Pixels.Left);
+		int Top = std::max(TileTop, Current.Pixels.Top);
+		int Right = std::min(TileRight, Current.Pixels.Left+Current.Pixels.Width);
+		int Bottom = std::min(TileBottom, Current.Pixels.Top+Current.Pixels.Height);
+		if (Left >= Right || Top >= Bottom)
+			continue;
+		unsigned int Count = Right-Left;
+
+		// Plain quads are a solid span on every row
+		if (!Current.Texture){
+			if (Current.Blend != sf::Blend::None)
+				FillSpan(&Span[0], Current.Color, Count);
+			for (int y = Top; y < Bottom; ++y){
+				if (Current.Blend == sf::Blend::None)
+					FillSpan(&Pixels[y*Width+Left], Current.Color, Count);
+				else
+					BlendSpan(&Pixels[y*Width+Left], &Span[0], Count, Current.Blend);
+			}
+			continue;
+		}
+
+		// Textured quads sample the nearest texel at each pixel's center
+		const TextureData &Texture = *Current.Texture;
+		const sf::Uint32 *TexturePixels = reinterpret_cast<const sf::Uint32 *>(Texture.Pixels);
+		float StepU = (Current.U1-Current.U0)/(Current.Right-Current.Left);
+		float StepV = (Current.V1-Current.V0)/(Current.Bottom-Current.Top);
+		float StartU = Current.U0+(Left+0.5-Current.Left)*StepU;
+		bool Tinted = Current.Color != 0xFFFFFFFF;
+		for (int y = Top; y < Bottom; ++y){
+			int TexelY = std::floor(Current.V0+(y+0.5-Current.Top)*StepV);
+			TexelY = std::min<int>(std::max<int>(TexelY, 0), Texture.Height-1);
+			const sf::Uint32 *TextureRow = TexturePixels+TexelY*Texture.Width;
+			float U = StartU;
+			for (unsigned int x = 0; x < Count; ++x){
+				int TexelX = std::min<int>(std::max<int>(std::floor(U), 0), Texture.Width-1);
+				Span[x] = TextureRow[TexelX];
+				U += StepU;
+			}
+			if (Tinted)
+				ModulateSpan(&Span[0], Current.Color, Count);
+			BlendSpan(&Pixels[y*Width+Left], &Span[0], Count, Current.Blend);
+		}
+	}
+}
+
+void terra::SoftwareRenderer::RunJob(Job *Work){
+	// Each thread has its own span buffer, big enough for a tile's row
+	std::vector<sf::Uint32> Span(TileSize);
+	SoftwareRenderer &Renderer = *Work->Renderer;
+	unsigned int Threads = std::min(Renderer.ThreadCount, Renderer.BinsX*Renderer.BinsY);
+	for (unsigned int i = Work->First; i < Renderer.Bins.size(); i += Threads)
+		if (!Renderer.Bins[i].empty())
+			Renderer.RasterizeTile(i, Span);
+}
+
+bool terra::SoftwareRenderer::SaveToFile(const std::string &Filename) const{
+	std::ofstream File(Filename.c_str(), std::ios::out|std::ios::binary);
+	if (!File.good())
+		return false;
+
+	// Uncompressed true color with alpha, stored top to bottom
+	unsigned char Header[18] = {0};
+	Header[2] = 2;
+	Header[12] = Width&0xFF;
+	Header[13] = (Width>>8)&0xFF;
+	Header[14] = Height&0xFF;
+	Header[15] = (Height>>8)&0xFF;
+	Header[16] = 32;
+	Header[17] = 0x28;
+	File.write(reinterpret_cast<const char *>(Header), 18);
+
+	// TGA wants BGRA
+	std::vector<sf::Uint8> Row(Width*4);
+	for (unsigned int y = 0; y < Height; ++y){
+		const sf::Uint8 *Source = GetPixels()+y*Width*4;
+		for (unsigned int x = 0; x < Width; ++x){
+			Row[x*4] = Source[x*4+2];
+			Row[x*4+1] = Source[x*4+1];
+			Row[x*4+2] = Source[x*4];
+			Row[x*4+3] = Source[x*4+3];
+		}
+		if (Width)
+			File.write(reinterpret_cast<const char *>(&Row[0]), Row.size());
+	}
+	return File.good();
+}
+
+void terra::SoftwareRenderer::SetView(const sf::View &NewView){
+	View = NewView;
+	Null.SetView(NewView);
+
+	// Work out how world coordinates map onto pixels, and which pixels the viewport covers
+	sf::FloatRect ViewRect = GetViewRect(View);
+	sf::FloatRect Viewport = View.GetViewport();
+	ScaleX = Viewport.Width*Width/ViewRect.Width;
+	ScaleY = Viewport.Height*Height/ViewRect.Height;
+	OffsetX = Viewport.Left*Width-ViewRect.Left*ScaleX;
+	OffsetY = Viewport.Top*Height-ViewRect.Top*ScaleY;
+	int Left = std::max<int>(0, std::floor(Viewport.Left*Width+0.5));
+	int Top = std::max<int>(0, std::floor(Viewport.Top*Height+0.5));
+	int Right = std::min<int>(Width, std::floor((Viewport.Left+Viewport.Width)*Width+0.5));
+	int Bottom = std::min<int>(Height, std::floor((Viewport.Top+Viewport.Height)*Height+0.5));
+	Clip = sf::IntRect(Left, Top, std::max(0, Right-Left), std::max(0, Bottom-Top));
+}
+
+terra::SoftwareRenderer::~SoftwareRenderer(){
+}
@@ -0,0 +1,172 @@
+#ifndef TERRA_SOFTWARERENDERER_HPP
+#define TERRA_SOFTWARERENDERER_HPP
+
+#include <map>
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+#include "NullTarget.hpp"
+#include "RenderBackend.hpp"
+#include "ThreadPool.hpp"
+
+namespace terra{
+	/*!
+	 * \brief A software renderer
+	 *
+	 * A render backend which rasterizes on the processor into an RGBA image in memory, for rendering without a graphics card. Quads are queued as they are drawn, sorted into 64x64 pixel screen tiles, and rasterized by several threads at once when Display() is called, one tile at a time. The threads are started once and sleep in between frames. Only axis aligned quads can be rasterized, so rotated quads are skipped, and views are assumed not to be rotated. SFML drawables can't be drawn either. Everything skipped is counted, so that missing pieces of a frame don't go unnoticed.
+	 */
+	class SoftwareRenderer : public RenderBackend{
+		private:
+			struct TextureData{
+				const sf::Uint8 *Pixels;
+				unsigned int Width;
+				unsigned int Height;
+				sf::FloatRect Coords;
+			};
+			struct Primitive{
+				float Left;
+				float Top;
+				float Right;
+				float Bottom;
+				float U0;
+				float V0;
+				float U1;
+				float V1;
+				sf::IntRect Pixels;
+				const TextureData *Texture;
+				sf::Uint32 Color;
+				sf::Blend::Mode Blend;
+			};
+			struct Job{
+				SoftwareRenderer *Renderer;
+				unsigned int First;
+			};
+			unsigned int Width;
+			unsigned int Height;
+			std::vector<sf::Uint32> Pixels;
+			NullTarget Null;
+			sf::View View;
+			float ScaleX;
+			float ScaleY;
+			float OffsetX;
+			float OffsetY;
+			sf::IntRect Clip;
+			std::map<const sf::Image *, TextureData> Textures;
+			std::vector<Primitive> Primitives;
+			std::vector<std::vector<unsigned int>> Bins;
+			unsigned int BinsX;
+			unsigned int BinsY;
+			unsigned int Skipped;
+			unsigned int ThreadCount;
+			ThreadPool Workers;
+			static void RunJob(Job *Work);
+			void RasterizeTile(unsigned int Tile, std::vector<sf::Uint32> &Span);
+		public:
+			/*!
+			 * The width and height of the screen tiles, in pixels.
+			 */
+			static const unsigned int TileSize = 64;
+
+			/*!
+			 * \param NewWidth The width of the image to render to
+			 * \param NewHeight The height of the image to render to
+			 * \param NewThreadCount The number of threads to rasterize with
+			 *
+			 * Create a new software renderer.
+			 */
+			SoftwareRenderer(unsigned int NewWidth, unsigned int NewHeight, unsigned int NewThreadCount = 4);
+
+			/*!
+			 * \param Color The color to clear to
+			 *
+			 * Throw out every queued quad and clear the image to a single color.
+			 */
+			void Clear(const sf::Color &Color = sf::Color::Black);
+
+			/*!
+			 * Rasterize every queued quad into the image.
+			 */
+			void Display();
+
+			/*!
+			 * \param Texture The texture to draw from, or a null pointer to draw plain colored quads
+			 * \param Vertices An array of vertices, four per quad
+			 * \param VertexCount The number of vertices in the array
+			 * \param Blend The blend mode to draw with
+			 *
+			 * Queue a list of quads to be rasterized by the next call to Display(). The texture must stay alive until then.
+			 */
+			void DrawQuads(const sf::Image *Texture, const Vertex *Vertices, unsigned int VertexCount, sf::Blend::Mode Blend = sf::Blend::Alpha);
+
+			/*!
+			 * \return The height of the image
+			 *
+			 * Retrieve the height of the image.
+			 */
+			unsigned int GetHeight() const;
+
+			/*!
+			 * \return A pointer to the image's pixels
+			 *
+			 * Retrieve the image's pixels, as rows of RGBA bytes from top to bottom.
+			 */
+			const sf::Uint8 *GetPixels() const;
+
+			/*!
+			 * \return The number of things that couldn't be drawn
+			 *
+			 * Retrieve how many rotated quads, and how many SFML drawables drawn onto the target from GetTarget(), have been left out since the renderer was created.
+			 */
+			const unsigned int GetSkippedCount() const;
+
+			/*!
+			 * \return A target that ignores everything drawn onto it
+			 *
+			 * The software renderer can't draw SFML drawables, so items have to submit their sprites and text to the engine's sprite batcher to be seen. Anything drawn onto the target is counted by GetSkippedCount().
+			 */
+			sf::RenderTarget &GetTarget();
+
+			/*!
+			 * \return The current view
+			 *
+			 * Retrieve the current view.
+			 */
+			const sf::View &GetView() const;
+
+			/*!
+			 * \return The width of the image
+			 *
+			 * Retrieve the width of the image.
+			 */
+			unsigned int GetWidth() const;
+
+			/*!
+			 * \return Always false
+			 *
+			 * The software renderer doesn't use the graphics card.
+			 */
+			const bool IsHardware() const;
+
+			/*!
+			 * \param Filename The name of the file to save to
+			 * \return True if the image was saved, false otherwise
+			 *
+			 * Save the image as an uncompressed TGA file.
+			 */
+			bool SaveToFile(const std::string &Filename) const;
+
+			/*!
+			 * \param NewView The new view
+			 *
+			 * Change the view that later quads are drawn through.
+			 */
+			void SetView(const sf::View &NewView);
+
+			/*!
+			 * Destroy the software renderer.
+			 */
+			~SoftwareRenderer();
+	};
+}
+
+#endif
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include "SpriteBatch.hpp"
+
+terra::SpriteBatch::SpriteBatch(){
+}
+
+void terra::SpriteBatch::AddQuad(const sf::Image &Texture, const sf::Vector2f Corners[4], const sf::FloatRect &Coords, const sf::Color &Color, sf::Blend::Mode Blend, int Depth){
+	// Remember what the quad is drawn with
+	Quad NewQuad;
+	NewQuad.Texture = &Texture;
+	NewQuad.Blend = Blend;
+	NewQuad.Depth = Depth;
+	NewQuad.Index = Vertices.size();
+	Quads.push_back(NewQuad);
+
+	// Store the corners in quad order
+	terra::Vertex Corner;
+	Corner.Color = Color;
+	Corner.Position = Corners[0];
+	Corner.TexCoords = sf::Vector2f(Coords.Left, Coords.Top);
+	Vertices.push_back(Corner);
+	Corner.Position = Corners[1];
+	Corner.TexCoords = sf::Vector2f(Coords.Left, Coords.Top+Coords.Height);
+	Vertices.push_back(Corner);
+	Corner.Position = Corners[2];
+	Corner.TexCoords = sf::Vector2f(Coords.Left+Coords.Width, Coords.Top+Coords.Height);
+	Vertices.push_back(Corner);
+	Corner.Position = Corners[3];
+	Corner.TexCoords = sf::Vector2f(Coords.Left+Coords.Width, Coords.Top);
+	Vertices.push_back(Corner);
+}
+
+void terra::SpriteBatch::Clear(){
+	Quads.clear();
+	Vertices.clear();
+}
+
+void terra::SpriteBatch::Draw(const sf::Image &Texture, const sf::IntRect &SubRect, const sf::FloatRect &Destination, const sf::Color &Color, sf::Blend::Mode Blend, int Depth){
+	float Right = Destination.Left+Destination.Width;
+	float Bottom = Destination.Top+Destination.Height;
+	sf::Vector2f Corners[4] = {sf::Vector2f(Destination.Left, Destination.Top), sf::Vector2f(Destination.Left, Bottom), sf::Vector2f(Right, Bottom), sf::Vector2f(Right, Destination.Top)};
+	AddQuad(Texture, Corners, Texture.GetTexCoords(SubRect), Color, Blend, Depth);
+}
+
+void terra::SpriteBatch::Draw(const terra::AtlasRegion &Region, const sf::Vector2f &Position, const sf::Color &Color, sf::Blend::Mode Blend, int Depth){
+	if (!Region.Page)
+		return;
+	Draw(*Region.Page, Region.Rect, sf::FloatRect(Position.x, Position.y, Region.Rect.Width, Region.Rect.Height), Color, Blend, Depth);
+}
+
+void terra::SpriteBatch::Draw(const sf::Sprite &Sprite, int Depth){
+	if (Sprite.GetImage() == nullptr)
+		return;
+
+	// The sprite's own transform places each corner of its sub-rectangle in the world
+	const sf::IntRect &SubRect = Sprite.GetSubRect();
+	float Width = SubRect.Width;
+	float Height = SubRect.Height;
+	sf::Vector2f Corners[4] = {Sprite.TransformToGlobal(sf::Vector2f(0, 0)), Sprite.TransformToGlobal(sf::Vector2f(0, Height)), Sprite.TransformToGlobal(sf::Vector2f(Width, Height)), Sprite.TransformToGlobal(sf::Vector2f(Width, 0))};
+	AddQuad(*Sprite.GetImage(), Corners, Sprite.GetImage()->GetTexCoords(SubRect), Sprite.GetColor(), Sprite.GetBlendMode(), Depth);
+}
+
+void terra::SpriteBatch::Draw(const sf::Text &Text, int Depth){
+	// Lay the glyphs out along the baseline the same way sf::Text does, starting one line down
+	const sf::Font &Font = Text.GetFont();
+	const sf::String &String = Text.GetString();
+	unsigned int Size = Text.GetCharacterSize();
+	bool Bold = (Text.GetStyle() & sf::Text::Bold) != 0;
+
+	// Loading a glyph can grow the font's image, so load them all before working out any texture coordinates
+	for (std::size_t i = 0; i < String.GetSize(); ++i)
+		Font.GetGlyph(String[i], Size, Bold);
+	const sf::Image &Image = Font.GetImage(Size);
+	float Space = Font.GetGlyph(' ', Size, Bold).Advance;
+	float X = 0.;
+	float Y = Size;
+	sf::Uint32 Previous = 0;
+	for (std::size_t i = 0; i < String.GetSize(); ++i){
+		sf::Uint32 Current = String[i];
+		X += Font.GetKerning(Previous, Current, Size);
+		Previous = Current;
+
+		// Whitespace only moves the pen
+		if (Current == '\n'){
+			X = 0.;
+			Y += Font.GetLineSpacing(Size);
+			continue;
+		}
+		if (Current == '\t'){
+			X += Space*4;
+			continue;
+		}
+
+		// Only visible glyphs need a quad
+		const sf::Glyph &Glyph = Font.GetGlyph(Current, Size, Bold);
+		if (Glyph.Bounds.Width && Glyph.Bounds.Height){
+			float Left = X+Glyph.Bounds.Left;
+			float Top = Y+Glyph.Bounds.Top;
+			float Right = Left+Glyph.Bounds.Width;
+			float Bottom = Top+Glyph.Bounds.Height;
+			sf::Vector2f Corners[4] = {Text.TransformToGlobal(sf::Vector2f(Left, Top)), Text.TransformToGlobal(sf::Vector2f(Left, Bottom)), Text.TransformToGlobal(sf::Vector2f(Right, Bottom)), Text.TransformToGlobal(sf::Vector2f(Right, Top))};
+			AddQuad(Image, Corners, Image.GetTexCoords(Glyph.SubRect), Text.GetColor(), Text.GetBlendMode(), Depth);
+		}
+		X += Glyph.Advance;
+	}
+}
+
+void terra::SpriteBatch::Flush(terra::RenderBackend &Backend){
+	if (Quads.empty())
+		return;
+
+	// Only the depth reorders quads, so the way they overlap never depends on where their textures live in memory
+	std::stable_sort(Quads.begin(), Quads.end(), Precedes);
+	Sorted.clear();
+	for (auto i = Quads.begin(); i != Quads.end(); ++i)
+		Sorted.insert(Sorted.end(), Vertices.begin()+i->Index, Vertices.begin()+i->Index+4);
+
+	// Then draw each run of quads sharing a texture and blend mode in one go
+	unsigned int Start = 0;
+	for (unsigned int i = 1; i <= Quads.size(); ++i){
+		if (i < Quads.size() && Quads[i].Texture == Quads[Start].Texture && Quads[i].Blend == Quads[Start].Blend)
+			continue;
+		Backend.DrawQuads(Quads[Start].Texture, &Sorted[Start*4], (i-Start)*4, Quads[Start].Blend);
+		Start = i;
+	}
+	Clear();
+}
+
+unsigned int terra::SpriteBatch::GetQuadCount() const{
+	return Quads.size();
+}
+
+bool terra::SpriteBatch::Precedes(const Quad &A, const Quad &B){
+	return A.Depth < B.Depth;
+}
+
+terra::SpriteBatch::~SpriteBatch(){
+}
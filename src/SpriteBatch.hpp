@@ -0,0 +1,100 @@
+#ifndef TERRA_SPRITEBATCH_HPP
+#define TERRA_SPRITEBATCH_HPP
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "AtlasRegion.hpp"
+#include "RenderBackend.hpp"
+#include "Vertex.hpp"
+
+namespace terra{
+	/*!
+	 * \brief A sprite batcher
+	 *
+	 * Collects textured quads submitted by objects while a layer is rendered, then draws them in order, merging neighboring quads that share a texture and blend mode into one draw.
+	 */
+	class SpriteBatch{
+		private:
+			struct Quad{
+				const sf::Image *Texture;
+				sf::Blend::Mode Blend;
+				int Depth;
+				unsigned int Index;
+			};
+			std::vector<Quad> Quads;
+			std::vector<Vertex> Vertices;
+			std::vector<Vertex> Sorted;
+			void AddQuad(const sf::Image &Texture, const sf::Vector2f Corners[4], const sf::FloatRect &Coords, const sf::Color &Color, sf::Blend::Mode Blend, int Depth);
+			static bool Precedes(const Quad &A, const Quad &B);
+		public:
+			/*!
+			 * Create a new, empty sprite batcher.
+			 */
+			SpriteBatch();
+
+			/*!
+			 * Throw out every submitted quad without drawing it.
+			 */
+			void Clear();
+
+			/*!
+			 * \param Texture The texture to draw from, which must stay alive until the batch is flushed
+			 * \param SubRect The area of the texture to draw
+			 * \param Destination The area of the world to draw to
+			 * \param Color The color to multiply the texture by
+			 * \param Blend The blend mode to draw with
+			 * \param Depth Quads with a higher depth are drawn over ones with a lower depth, whatever order they were submitted in
+			 *
+			 * Submit a textured quad to be drawn when the batch is next flushed.
+			 */
+			void Draw(const sf::Image &Texture, const sf::IntRect &SubRect, const sf::FloatRect &Destination, const sf::Color &Color = sf::Color::White, sf::Blend::Mode Blend = sf::Blend::Alpha, int Depth = 0);
+
+			/*!
+			 * \param Region The region of the texture atlas to draw from
+			 * \param Position The position of the quad's top left corner in the world
+			 * \param Color The color to multiply the texture by
+			 * \param Blend The blend mode to draw with
+			 * \param Depth Quads with a higher depth are drawn over ones with a lower depth, whatever order they were submitted in
+			 *
+			 * Submit an image from the texture atlas, at its natural size, to be drawn when the batch is next flushed.
+			 */
+			void Draw(const AtlasRegion &Region, const sf::Vector2f &Position, const sf::Color &Color = sf::Color::White, sf::Blend::Mode Blend = sf::Blend::Alpha, int Depth = 0);
+
+			/*!
+			 * \param Sprite The sprite to draw, whose image must stay alive until the batch is flushed
+			 * \param Depth Quads with a higher depth are drawn over ones with a lower depth, whatever order they were submitted in
+			 *
+			 * Submit a sprite, with its position, origin, scale, rotation, sub-rectangle, color, and blend mode, to be drawn when the batch is next flushed. Unlike drawing it onto the target given to OnRender, this works with every backend. Flipping is ignored.
+			 */
+			void Draw(const sf::Sprite &Sprite, int Depth = 0);
+
+			/*!
+			 * \param Text The text to draw, whose font must stay alive until the batch is flushed
+			 * \param Depth Quads with a higher depth are drawn over ones with a lower depth, whatever order they were submitted in
+			 *
+			 * Submit a piece of text, one quad per glyph, to be drawn when the batch is next flushed. Glyphs are laid out the same way sf::Text does, with its transform, color, and blend mode. Unlike drawing it onto the target given to OnRender, this works with every backend. Italic and underlined styles are ignored.
+			 */
+			void Draw(const sf::Text &Text, int Depth = 0);
+
+			/*!
+			 * \param Backend The backend to be rendered to
+			 *
+			 * Draw the submitted quads onto a backend, then empty the batch. Quads are drawn by depth and then in the order they were submitted, so overlapping quads always stack the same way. Each run of neighboring quads sharing a texture and blend mode is drawn in one go.
+			 */
+			void Flush(RenderBackend &Backend);
+
+			/*!
+			 * \return The number of quads waiting to be drawn
+			 *
+			 * Retrieve the number of quads waiting to be drawn.
+			 */
+			unsigned int GetQuadCount() const;
+
+			/*!
+			 * Destroy the sprite batcher.
+			 */
+			~SpriteBatch();
+	};
+}
+
+#endif
@@ -0,0 +1,48 @@
+#include "TargetBackend.hpp"
+
+void terra::TargetBackend::QuadList::Render(sf::RenderTarget &, sf::Renderer &Renderer) const{
+	// Submit every quad in one go
+	Renderer.SetTexture(Texture);
+	Renderer.Begin(sf::Renderer::QuadList);
+	for (unsigned int i = 0; i < VertexCount; ++i)
+		Renderer.AddVertex(Vertices[i].Position.x, Vertices[i].Position.y, Vertices[i].TexCoords.x, Vertices[i].TexCoords.y, Vertices[i].Color);
+	Renderer.End();
+}
+
+terra::TargetBackend::TargetBackend(sf::RenderTarget &NewTarget) : Target(NewTarget){
+}
+
+void terra::TargetBackend::Clear(const sf::Color &Color){
+	Target.Clear(Color);
+}
+
+void terra::TargetBackend::DrawQuads(const sf::Image *Texture, const terra::Vertex *Vertices, unsigned int VertexCount, sf::Blend::Mode Blend){
+	if (!VertexCount)
+		return;
+	Count(Texture, VertexCount);
+	QuadList Quads;
+	Quads.Texture = Texture;
+	Quads.Vertices = Vertices;
+	Quads.VertexCount = VertexCount;
+	Quads.SetBlendMode(Blend);
+	Target.Draw(Quads);
+}
+
+sf::RenderTarget &terra::TargetBackend::GetTarget(){
+	return Target;
+}
+
+const sf::View &terra::TargetBackend::GetView() const{
+	return Target.GetView();
+}
+
+const bool terra::TargetBackend::IsHardware() const{
+	return true;
+}
+
+void terra::TargetBackend::SetView(const sf::View &View){
+	Target.SetView(View);
+}
+
+terra::TargetBackend::~TargetBackend(){
+}
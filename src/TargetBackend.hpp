@@ -0,0 +1,84 @@
+#ifndef TERRA_TARGETBACKEND_HPP
+#define TERRA_TARGETBACKEND_HPP
+
+#include <SFML/Graphics.hpp>
+#include "RenderBackend.hpp"
+
+namespace terra{
+	/*!
+	 * \brief A backend for SFML render targets
+	 *
+	 * A render backend which draws onto an SFML render target, such as the game window or an sf::RenderImage.
+	 */
+	class TargetBackend : public RenderBackend{
+		private:
+			class QuadList : public sf::Drawable{
+				public:
+					const sf::Image *Texture;
+					const Vertex *Vertices;
+					unsigned int VertexCount;
+				protected:
+					void Render(sf::RenderTarget &Target, sf::Renderer &Renderer) const;
+			};
+			sf::RenderTarget &Target;
+		public:
+			/*!
+			 * \param NewTarget The target to draw onto, which must outlive the backend
+			 *
+			 * Create a new backend for a render target.
+			 */
+			TargetBackend(sf::RenderTarget &NewTarget);
+
+			/*!
+			 * \param Color The color to clear to
+			 *
+			 * Clear the whole target to a single color.
+			 */
+			void Clear(const sf::Color &Color = sf::Color::Black);
+
+			/*!
+			 * \param Texture The texture to draw from, or a null pointer to draw plain colored quads
+			 * \param Vertices An array of vertices, four per quad
+			 * \param VertexCount The number of vertices in the array
+			 * \param Blend The blend mode to draw with
+			 *
+			 * Draw a list of quads onto the target.
+			 */
+			void DrawQuads(const sf::Image *Texture, const Vertex *Vertices, unsigned int VertexCount, sf::Blend::Mode Blend = sf::Blend::Alpha);
+
+			/*!
+			 * \return The render target
+			 *
+			 * Retrieve the render target.
+			 */
+			sf::RenderTarget &GetTarget();
+
+			/*!
+			 * \return The current view
+			 *
+			 * Retrieve the target's current view.
+			 */
+			const sf::View &GetView() const;
+
+			/*!
+			 * \return Always true
+			 *
+			 * SFML targets draw with the graphics card.
+			 */
+			const bool IsHardware() const;
+
+			/*!
+			 * \param View The new view
+			 *
+			 * Change the target's view.
+			 */
+			void SetView(const sf::View &View);
+
+			/*!
+			 * Destroy the backend.
+			 */
+			~TargetBackend();
+	};
+}
+
+#endif
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include "TextureAtlas.hpp"
+
+namespace{
+	// Pack tall images first, the skyline stays flatter that way
+	bool TallerThan(const std::pair<std::string, std::shared_ptr<sf::Image>> &A, const std::pair<std::string, std::shared_ptr<sf::Image>> &B){
+		if (A.second->GetHeight() != B.second->GetHeight())
+			return A.second->GetHeight() > B.second->GetHeight();
+		return A.second->GetWidth() > B.second->GetWidth();
+	}
+}
+
+terra::TextureAtlas::TextureAtlas(){
+}
+
+void terra::TextureAtlas::Add(const std::string &Name, std::shared_ptr<sf::Image> Image){
+	// Skip images that failed to load or can never fit
+	if (!Image || !Image->GetWidth() || !Image->GetHeight() || Image->GetWidth()+Padding*2 > PageSize || Image->GetHeight()+Padding*2 > PageSize)
+		return;
+	Pending[Name] = Image;
+}
+
+void terra::TextureAtlas::Build(){
+	// Nothing new to pack
+	if (Pending.empty())
+		return;
+
+	// Every image gets repacked so the pages stay tight, starting with the ones that were already packed
+	std::vector<std::pair<std::string, std::shared_ptr<sf::Image>>> Images;
+	for (auto i = Regions.begin(); i != Regions.end(); ++i){
+		if (Pending.find(i->first) != Pending.end())
+			continue;
+		std::shared_ptr<sf::Image> Copy(new sf::Image);
+		Copy->Create(i->second.Rect.Width, i->second.Rect.Height, sf::Color(0, 0, 0, 0));
+		Copy->Copy(*i->second.Page, 0, 0, i->second.Rect);
+		Images.push_back(std::pair<std::string, std::shared_ptr<sf::Image>>(i->first, Copy));
+	}
+	Images.insert(Images.end(), Pending.begin(), Pending.end());
+	std::sort(Images.begin(), Images.end(), TallerThan);
+	Pending.clear();
+	Regions.clear();
+	Pages.clear();
+
+	// Fill pages one at a time until everything is packed
+	while (!Images.empty()){
+		std::vector<SkylineSegment> Skyline;
+		SkylineSegment Floor = {0, 0, PageSize};
+		Skyline.push_back(Floor);
+		std::vector<std::pair<std::string, std::shared_ptr<sf::Image>>> Leftovers;
+		std::map<std::string, sf::IntRect> Placed;
+		unsigned int UsedHeight = 0;
+
+		// Place whatever fits, and save the rest for the next page
+		for (auto i = Images.begin(); i != Images.end(); ++i){
+			unsigned int Width = i->second->GetWidth()+Padding*2;
+			unsigned int Height = i->second->GetHeight()+Padding*2;
+			unsigned int X, Y, Index;
+			if (!FindPosition(Skyline, Width, Height, X, Y, Index)){
+				Leftovers.push_back(*i);
+				continue;
+			}
+			Place(Skyline, Index, X, Y, Width, Height);
+			Placed[i->first] = sf::IntRect(X+Padding, Y+Padding, i->second->GetWidth(), i->second->GetHeight());
+			UsedHeight = std::max(UsedHeight, Y+Height);
+		}
+
+		// Copy the placed images into a page just tall enough to hold them
+		std::shared_ptr<sf::Image> Page(new sf::Image);
+		Page->Create(PageSize, UsedHeight, sf::Color(0, 0, 0, 0));
+		for (auto i = Images.begin(); i != Images.end(); ++i){
+			auto Position = Placed.find(i->first);
+			if (Position == Placed.end())
+				continue;
+			Page->Copy(*i->second, Position->second.Left, Position->second.Top);
+			AtlasRegion Region;
+			Region.Page = Page;
+			Region.Rect = Position->second;
+			Regions[i->first] = Region;
+		}
+		Page->SetSmooth(false);
+		Pages.push_back(Page);
+		Images.swap(Leftovers);
+	}
+}
+
+void terra::TextureAtlas::Clear(){
+	Pending.clear();
+	Regions.clear();
+	Pages.clear();
+}
+
+const terra::AtlasRegion *terra::TextureAtlas::Find(const std::string &Name) const{
+	auto Region = Regions.find(Name);
+	if (Region == Regions.end())
+		return nullptr;
+	return &Region->second;
+}
+
+bool terra::TextureAtlas::FindPosition(const std::vector<SkylineSegment> &Skyline, unsigned int Width, unsigned int Height, unsigned int &BestX, unsigned int &BestY, unsigned int &BestIndex) const{
+	// Try resting the image on each segment, and keep the lowest spot
+	bool Found = false;
+	for (unsigned int i = 0; i < Skyline.size(); ++i){
+		// The image can't hang off the right side of the page
+		unsigned int X = Skyline[i].X;
+		if (X+Width > PageSize)
+			break;
+
+		// The image sits on the highest segment underneath it
+		unsigned int Y = 0;
+		unsigned int Covered = 0;
+		for (unsigned int j = i; j < Skyline.size() && Covered < Width; ++j){
+			Y = std::max(Y, Skyline[j].Y);
+			Covered += Skyline[j].Width;
+		}
+		if (Y+Height > PageSize)
+			continue;
+
+		// Keep the spot if it's the lowest so far
+		if (!Found || Y < BestY){
+			BestX = X;
+			BestY = Y;
+			BestIndex = i;
+			Found = true;
+		}
+	}
+	return Found;
+}
+
+unsigned int terra::TextureAtlas::GetPageCount() const{
+	return Pages.size();
+}
+
+void terra::TextureAtlas::Place(std::vector<SkylineSegment> &Skyline, unsigned int Index, unsigned int X, unsigned int Y, unsigned int Width, unsigned int Height) const{
+	// Raise the skyline over the image
+	SkylineSegment Roof = {X, Y+Height, Width};
+	Skyline.insert(Skyline.begin()+Index, Roof);
+
+	// Shrink or remove the segments that are now underneath it
+	for (unsigned int i = Index+1; i < Skyline.size();){
+		unsigned int Right = Roof.X+Roof.Width;
+		if (Skyline[i].X >= Right)
+			break;
+		unsigned int Overlap = Right-Skyline[i].X;
+		if (Overlap >= Skyline[i].Width){
+			Skyline.erase(Skyline.begin()+i);
+			continue;
+		}
+		Skyline[i].X += Overlap;
+		Skyline[i].Width -= Overlap;
+		break;
+	}
+
+	// Merge neighbors of equal height
+	for (unsigned int i = 0; i+1 < Skyline.size();){
+		if (Skyline[i].Y == Skyline[i+1].Y){
+			Skyline[i].Width += Skyline[i+1].Width;
+			Skyline.erase(Skyline.begin()+i+1);
+			continue;
+		}
+		++i;
+	}
+}
+
+terra::TextureAtlas::~TextureAtlas(){
+}
@@ -0,0 +1,87 @@
+#ifndef TERRA_TEXTUREATLAS_HPP
+#define TERRA_TEXTUREATLAS_HPP
+
+#include <map>
+#include <memory>
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+#include "AtlasRegion.hpp"
+
+namespace terra{
+	/*!
+	 * \brief A texture atlas
+	 *
+	 * A set of large images (pages) that many smaller images are packed into, so that things drawn from different images can share a texture.
+ *
+ * Packed images are copied, not moved, so an image that is still held elsewhere takes up memory twice: once on its own and once in a page.
+	 */
+	class TextureAtlas{
+		private:
+			struct SkylineSegment{
+				unsigned int X;
+				unsigned int Y;
+				unsigned int Width;
+			};
+			std::map<std::string, std::shared_ptr<sf::Image>> Pending;
+			std::map<std::string, AtlasRegion> Regions;
+			std::vector<std::shared_ptr<sf::Image>> Pages;
+			bool FindPosition(const std::vector<SkylineSegment> &Skyline, unsigned int Width, unsigned int Height, unsigned int &BestX, unsigned int &BestY, unsigned int &BestIndex) const;
+			void Place(std::vector<SkylineSegment> &Skyline, unsigned int Index, unsigned int X, unsigned int Y, unsigned int Width, unsigned int Height) const;
+		public:
+			/*!
+			 * The width and maximum height of every page, in pixels.
+			 */
+			static const unsigned int PageSize = 2048;
+
+			/*!
+			 * The number of transparent pixels left around every packed image.
+			 */
+			static const unsigned int Padding = 1;
+
+			/*!
+			 * Create a new, empty texture atlas.
+			 */
+			TextureAtlas();
+
+			/*!
+			 * \param Name The name the image will be found under, usually its filename
+			 * \param Image The image to pack
+			 *
+			 * Queue an image to be packed by the next call to Build(). Images too large to fit in a page are left out.
+			 */
+			void Add(const std::string &Name, std::shared_ptr<sf::Image> Image);
+
+			/*!
+			 * Pack every queued image, along with every image that was already packed, into as few pages as possible using a skyline packer.
+			 */
+			void Build();
+
+			/*!
+			 * Remove every image and page from the atlas.
+			 */
+			void Clear();
+
+			/*!
+			 * \param Name The name of the image
+			 * \return A pointer to the region the image was packed into, or a null pointer if it isn't in the atlas
+			 *
+			 * Find where an image was packed.
+			 */
+			const AtlasRegion *Find(const std::string &Name) const;
+
+			/*!
+			 * \return The number of pages in the atlas
+			 *
+			 * Retrieve the number of pages in the atlas.
+			 */
+			unsigned int GetPageCount() const;
+
+			/*!
+			 * Destroy the texture atlas.
+			 */
+			~TextureAtlas();
+	};
+}
+
+#endif
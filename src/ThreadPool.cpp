@@ -0,0 +1,72 @@
+#include "ThreadPool.hpp"
+
+terra::ThreadPool::ThreadPool(unsigned int Count){
+	Active = 0;
+	Running = true;
+	for (unsigned int i = 0; i < Count; ++i)
+		Workers.push_back(std::thread(&terra::ThreadPool::Work, this));
+}
+
+void terra::ThreadPool::Add(const std::function<void()> &Task){
+	std::lock_guard<std::mutex> Lock(Guard);
+	Tasks.push_back(Task);
+	Ready.notify_one();
+}
+
+unsigned int terra::ThreadPool::GetHardwareThreads(){
+	unsigned int Count = std::thread::hardware_concurrency();
+	return Count > 0 ? Count : 1;
+}
+
+void terra::ThreadPool::RunNext(std::unique_lock<std::mutex> &Lock){
+	// Take the next task
+	std::function<void()> Task = Tasks.front();
+	Tasks.pop_front();
+	++Active;
+
+	// Run it outside the lock, and tell Wait() once the last running task is done
+	Lock.unlock();
+	Task();
+	Lock.lock();
+	if (--Active == 0)
+		Done.notify_all();
+}
+
+void terra::ThreadPool::Wait(){
+	std::unique_lock<std::mutex> Lock(Guard);
+	while (true){
+		if (!Tasks.empty()){
+			RunNext(Lock);
+			continue;
+		}
+
+		// Nothing left to pick up, so sleep until the workers finish theirs
+		if (Active == 0)
+			return;
+		Done.wait(Lock);
+	}
+}
+
+void terra::ThreadPool::Work(terra::ThreadPool *Pool){
+	std::unique_lock<std::mutex> Lock(Pool->Guard);
+	while (true){
+		// Sleep until there is a task, or the pool is stopped with none left
+		Pool->Ready.wait(Lock, [Pool](){
+			return !Pool->Tasks.empty() || !Pool->Running;
+		});
+		if (Pool->Tasks.empty())
+			return;
+		Pool->RunNext(Lock);
+	}
+}
+
+terra::ThreadPool::~ThreadPool(){
+	Wait();
+	{
+		std::lock_guard<std::mutex> Lock(Guard);
+		Running = false;
+		Ready.notify_all();
+	}
+	for (auto i = Workers.begin(); i != Workers.end(); ++i)
+		i->join();
+}
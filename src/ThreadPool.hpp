@@ -0,0 +1,64 @@
+#ifndef TERRA_THREADPOOL_HPP
+#define TERRA_THREADPOOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace terra{
+	/*!
+	 * \brief A pool of worker threads
+	 *
+	 * Runs queued tasks on a fixed set of worker threads. The thread that waits on the pool runs tasks as well, so a pool with no workers simply runs every task in Wait(). Idle workers sleep until a task is queued, so a pool can be kept around between bursts of work.
+	 */
+	class ThreadPool{
+		private:
+			unsigned int Active;
+			std::condition_variable Done;
+			std::mutex Guard;
+			std::condition_variable Ready;
+			bool Running;
+			std::deque<std::function<void()>> Tasks;
+			std::vector<std::thread> Workers;
+			void RunNext(std::unique_lock<std::mutex> &Lock);
+			static void Work(ThreadPool *Pool);
+			ThreadPool(const ThreadPool &Copy);
+			ThreadPool &operator=(const ThreadPool &Copy);
+		public:
+			/*!
+			 * \param Count The number of worker threads to start
+			 *
+			 * Create a new pool and start its workers.
+			 */
+			ThreadPool(unsigned int Count);
+
+			/*!
+			 * \param Task The task to run
+			 *
+			 * Queue a task to be run by the next free thread. Tasks may run in any order.
+			 */
+			void Add(const std::function<void()> &Task);
+
+			/*!
+			 * \return The number of threads the system can run at once, at least 1
+			 *
+			 * Find out how many threads the system can run at once.
+			 */
+			static unsigned int GetHardwareThreads();
+
+			/*!
+			 * Help run the queued tasks, and return once all of them are done.
+			 */
+			void Wait();
+
+			/*!
+			 * Finish every queued task, then stop the workers.
+			 */
+			~ThreadPool();
+	};
+}
+
+#endif
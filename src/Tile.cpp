@@ -25,11 +25,12 @@ void terra::Tile::OnFrame(){
 
 void terra::Tile::OnRender(sf::RenderTarget &Target){
 	// Abort if the needed texture doesn't exist
-	if (!GetTexture(Tileset))
+	std::shared_ptr<sf::Image> Texture = GetTexture(Tileset);
+	if (!Texture)
 		return;
 
 	// Render the tile
-	sf::Sprite RenderMe(*GetTexture(Tileset));
+	sf::Sprite RenderMe(*Texture);
 	RenderMe.SetSubRect(sf::IntRect(sf::Vector2<int>(TilePosition), sf::Vector2<int>(GetSize())));
 	RenderMe.SetPosition(GetPosition());
 	Target.Draw(RenderMe);
@@ -0,0 +1,36 @@
+#ifndef TERRA_TILEANIMATION_HPP
+#define TERRA_TILEANIMATION_HPP
+
+#include <SFML/System.hpp>
+#include <vector>
+
+namespace terra{
+	/*!
+	 * \brief Tile Animation
+	 *
+	 * A structure containing an animation sequence declared by a tileset. Tiles placed in a level with the position of the first frame play the whole sequence.
+	 */
+	struct TileAnimation{
+		/*!
+		 * The position of each frame in the tileset.
+		 */
+		std::vector<sf::Vector2<unsigned int>> Frames;
+
+		/*!
+		 * How long each frame is shown for, in seconds.
+		 */
+		std::vector<float> Durations;
+
+		/*!
+		 * How long the whole sequence takes, in seconds.
+		 */
+		float Length;
+
+		/*!
+		 * The frame currently being shown.
+		 */
+		unsigned int Frame;
+	};
+}
+
+#endif
@@ -0,0 +1,70 @@
+#include <cmath>
+#include "TileAnimator.hpp"
+
+terra::TileAnimator::TileAnimator(){
+	Time = 0.;
+	Version = 0;
+}
+
+void terra::TileAnimator::Add(const std::string &Tileset, const terra::TileAnimation &Animation){
+	if (Animation.Frames.empty() || Animation.Frames.size() != Animation.Durations.size() || Animation.Length <= 0.)
+		return;
+
+	// Tiles are matched to their animation by the position of the first frame
+	Lookup[std::make_pair(Tileset, std::make_pair(Animation.Frames[0].x, Animation.Frames[0].y))] = Animations.size();
+	Animations.push_back(Animation);
+	Animations.back().Frame = 0;
+	++Version;
+}
+
+void terra::TileAnimator::Clear(){
+	Animations.clear();
+	Lookup.clear();
+	Time = 0.;
+	++Version;
+}
+
+const int terra::TileAnimator::Find(const std::string &Tileset, const sf::Vector2<unsigned int> &TilePosition) const{
+	if (Animations.empty())
+		return -1;
+	auto Animation = Lookup.find(std::make_pair(Tileset, std::make_pair(TilePosition.x, TilePosition.y)));
+	return Animation == Lookup.end() ? -1 : Animation->second;
+}
+
+const terra::TileAnimation &terra::TileAnimator::GetAnimation(unsigned int Animation) const{
+	return Animations[Animation];
+}
+
+const sf::Vector2<unsigned int> &terra::TileAnimator::GetFrame(unsigned int Animation) const{
+	return Animations[Animation].Frames[Animations[Animation].Frame];
+}
+
+const unsigned int terra::TileAnimator::GetVersion() const{
+	return Version;
+}
+
+const bool terra::TileAnimator::IsEmpty() const{
+	return Animations.empty();
+}
+
+void terra::TileAnimator::Update(float Elapsed){
+	Time += Elapsed;
+	for (auto i = Animations.begin(); i != Animations.end(); ++i){
+		// Find the frame covering the current point of the sequence
+		float Position = std::fmod(Time, i->Length);
+		unsigned int Frame = 0;
+		while (Frame+1 < i->Durations.size() && Position >= i->Durations[Frame]){
+			Position -= i->Durations[Frame];
+			++Frame;
+		}
+
+		// Let the batches know that something changed
+		if (Frame != i->Frame){
+			i->Frame = Frame;
+			++Version;
+		}
+	}
+}
+
+terra::TileAnimator::~TileAnimator(){
+}
@@ -0,0 +1,95 @@
+#ifndef TERRA_TILEANIMATOR_HPP
+#define TERRA_TILEANIMATOR_HPP
+
+#include <map>
+#include <SFML/System.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+#include "TileAnimation.hpp"
+
+namespace terra{
+	/*!
+	 * \brief The table of animated tiles
+	 *
+	 * Keeps every tile animation declared by the project's tilesets, and which frame each of them is on. The table is advanced once per frame, which costs one step per animation no matter how many tiles play it; tile batches then look up the current frame of their animated tiles to remap their texture coordinates.
+	 */
+	class TileAnimator{
+		private:
+			std::vector<TileAnimation> Animations;
+			std::map<std::pair<std::string, std::pair<unsigned int, unsigned int>>, unsigned int> Lookup;
+			float Time;
+			unsigned int Version;
+		public:
+			/*!
+			 * Create a new, empty animation table.
+			 */
+			TileAnimator();
+
+			/*!
+			 * \param Tileset The filename of the tileset that the animation is from
+			 * \param Animation The animation, whose first frame is the tile that plays it
+			 *
+			 * Add an animation to the table. Animations without frames or with no length are ignored.
+			 */
+			void Add(const std::string &Tileset, const TileAnimation &Animation);
+
+			/*!
+			 * Remove every animation from the table.
+			 */
+			void Clear();
+
+			/*!
+			 * \param Tileset The filename of the tileset of the tile
+			 * \param TilePosition The position of the tile in the tileset
+			 * \return The index of the tile's animation, or -1 if it isn't animated
+			 *
+			 * Find the animation played by a tile.
+			 */
+			const int Find(const std::string &Tileset, const sf::Vector2<unsigned int> &TilePosition) const;
+
+			/*!
+			 * \param Animation The index of the animation
+			 * \return The animation
+			 *
+			 * Retrieve an animation from the table.
+			 */
+			const TileAnimation &GetAnimation(unsigned int Animation) const;
+
+			/*!
+			 * \param Animation The index of the animation
+			 * \return The position in the tileset of the animation's current frame
+			 *
+			 * Retrieve the frame an animation is currently showing.
+			 */
+			const sf::Vector2<unsigned int> &GetFrame(unsigned int Animation) const;
+
+			/*!
+			 * \return A number that changes every time any animation changes frames
+			 *
+			 * Retrieve the version of the table, so that batches can tell whether their texture coordinates are out of date.
+			 */
+			const unsigned int GetVersion() const;
+
+			/*!
+			 * \return True if no animations were declared, false otherwise
+			 *
+			 * Determines if the table is empty.
+			 */
+			const bool IsEmpty() const;
+
+			/*!
+			 * \param Elapsed The number of seconds since the last update
+			 *
+			 * Advance every animation.
+			 */
+			void Update(float Elapsed);
+
+			/*!
+			 * Destroy the animation table.
+			 */
+			~TileAnimator();
+	};
+}
+
+#endif
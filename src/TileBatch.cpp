@@ -0,0 +1,164 @@
+#include <algorithm>
+#include "TileBatch.hpp"
+#include "Utilities.hpp"
+
+terra::TileBatch::TileBatch(std::shared_ptr<sf::Image> NewTexture){
+	Texture = NewTexture;
+	AnimatedVersion = 0;
+}
+
+void terra::TileBatch::AddTile(const terra::Tile &NewTile, const sf::Vector2<unsigned int> &Offset, unsigned int Level, const terra::TileAnimator *Animations, unsigned int Animation){
+	float Left = NewTile.GetPosition().x;
+	float Top = NewTile.GetPosition().y;
+	float Right = Left+NewTile.GetSize().x;
+	float Bottom = Top+NewTile.GetSize().y;
+
+	// Grow the bounds to fit the tile
+	if (Vertices.empty())
+		Bounds = sf::FloatRect(Left, Top, Right-Left, Bottom-Top);
+	else{
+		float BoundsRight = std::max(Bounds.Left+Bounds.Width, Right);
+		float BoundsBottom = std::max(Bounds.Top+Bounds.Height, Bottom);
+		Bounds.Left = std::min(Bounds.Left, Left);
+		Bounds.Top = std::min(Bounds.Top, Top);
+		Bounds.Width = BoundsRight-Bounds.Left;
+		Bounds.Height = BoundsBottom-Bounds.Top;
+	}
+
+	// Store the corners of the tile in quad order
+	unsigned int First = Vertices.size();
+	terra::Vertex Corner;
+	Corner.Color = sf::Color::White;
+	Corner.Position = sf::Vector2f(Left, Top);
+	Vertices.push_back(Corner);
+	Corner.Position = sf::Vector2f(Left, Bottom);
+	Vertices.push_back(Corner);
+	Corner.Position = sf::Vector2f(Right, Bottom);
+	Vertices.push_back(Corner);
+	Corner.Position = sf::Vector2f(Right, Top);
+	Vertices.push_back(Corner);
+
+	// Static tiles show their own spot in the tileset, animated ones show the animation's current frame
+	sf::Vector2<unsigned int> TilePosition = NewTile.GetTilePosition();
+	if (Animations){
+		AnimatedTile NewAnimated;
+		NewAnimated.First = First;
+		NewAnimated.Animation = Animation;
+		NewAnimated.Offset = Offset;
+		NewAnimated.Size = NewTile.GetSize();
+		NewAnimated.Level = Level;
+		AnimatedTiles.push_back(NewAnimated);
+		AnimatedVersion = Animations->GetVersion();
+		TilePosition = Animations->GetFrame(Animation);
+	}
+	SetTexCoords(First, TilePosition, NewTile.GetSize(), Offset, Level);
+}
+
+bool terra::TileBatch::Animate(const terra::TileAnimator &Animations){
+	if (AnimatedTiles.empty() || AnimatedVersion == Animations.GetVersion())
+		return false;
+	AnimatedVersion = Animations.GetVersion();
+	for (auto i = AnimatedTiles.begin(); i != AnimatedTiles.end(); ++i)
+		SetTexCoords(i->First, Animations.GetFrame(i->Animation), i->Size, i->Offset, i->Level);
+	return true;
+}
+
+void terra::TileBatch::Build(const std::list<std::shared_ptr<terra::Item>> &Tiles, std::map<const sf::Image *, std::shared_ptr<terra::TileBatch>> &Batches, const terra::TextureAtlas &Atlas, const terra::TileAnimator &Animations, const terra::TilesetLOD &LODs, unsigned int Level, const terra::TileOcclusion *Occlusion, unsigned int Depth){
+	// Empty the old batches but keep them around, their storage gets reused
+	for (auto i = Batches.begin(); i != Batches.end(); ++i)
+		i->second->Clear();
+
+	// Neighboring tiles usually share a tileset, so only look the textures up when it changes
+	std::string Tileset;
+	std::shared_ptr<sf::Image> Reduced, Full;
+	sf::Vector2<unsigned int> FullOffset;
+	unsigned int ReducedLevel = 0;
+	bool First = true;
+
+	// Sort every tile into the batch of its texture
+	for (auto i = Tiles.begin(); i != Tiles.end(); ++i){
+		const terra::Tile &CurrentTile = static_cast<const terra::Tile &>(**i);
+		if (Occlusion && Occlusion->IsHidden(Depth, CurrentTile))
+			continue;
+		if (First || CurrentTile.GetTileset() != Tileset){
+			// Prefer a downscaled tileset when zoomed out, then the atlas, then the tileset itself
+			Tileset = CurrentTile.GetTileset();
+			ReducedLevel = Level;
+			Reduced = LODs.Find(Tileset, ReducedLevel);
+			const terra::AtlasRegion *Region = Atlas.Find(Tileset);
+			if (Region){
+				Full = Region->Page;
+				FullOffset = sf::Vector2<unsigned int>(Region->Rect.Left, Region->Rect.Top);
+			}
+			else{
+				Full = GetTexture(Tileset);
+				FullOffset = sf::Vector2<unsigned int>(0, 0);
+			}
+			First = false;
+		}
+
+		// Downscaled tilesets only keep whole cells of the grid, so every other tile, and every frame it animates through, has to come from full size
+		int Animation = Animations.Find(Tileset, CurrentTile.GetTilePosition());
+		sf::Vector2<unsigned int> Size(CurrentTile.GetSize());
+		bool Aligned = Reduced && LODs.IsAligned(Tileset, CurrentTile.GetTilePosition(), Size);
+		if (Aligned && Animation >= 0){
+			const std::vector<sf::Vector2<unsigned int>> &Frames = Animations.GetAnimation(Animation).Frames;
+			for (auto j = Frames.begin(); Aligned && j != Frames.end(); ++j)
+				Aligned = LODs.IsAligned(Tileset, *j, Size);
+		}
+		const std::shared_ptr<sf::Image> &Texture = Aligned ? Reduced : Full;
+
+		// Add the tile to its batch, creating the batch if needed
+		auto Batch = Batches.find(Texture.get());
+		if (Batch == Batches.end())
+			Batch = Batches.insert(std::pair<const sf::Image *, std::shared_ptr<terra::TileBatch>>(Texture.get(), std::shared_ptr<terra::TileBatch>(new terra::TileBatch(Texture)))).first;
+		Batch->second->AddTile(CurrentTile, Aligned ? sf::Vector2<unsigned int>(0, 0) : FullOffset, Aligned ? ReducedLevel : 0, Animation < 0 ? nullptr : &Animations, Animation < 0 ? 0 : Animation);
+	}
+}
+
+void terra::TileBatch::Clear(){
+	Vertices.clear();
+	AnimatedTiles.clear();
+	Bounds = sf::FloatRect(0., 0., 0., 0.);
+}
+
+void terra::TileBatch::Draw(terra::RenderBackend &Backend) const{
+	if (!Vertices.empty())
+		Backend.DrawQuads(Texture.get(), &Vertices[0], Vertices.size());
+}
+
+const sf::FloatRect &terra::TileBatch::GetBounds() const{
+	return Bounds;
+}
+
+unsigned int terra::TileBatch::GetTileCount() const{
+	return Vertices.size()/4;
+}
+
+unsigned int terra::TileBatch::GetVertexCount() const{
+	return Vertices.size();
+}
+
+const bool terra::TileBatch::IsAnimated() const{
+	return !AnimatedTiles.empty();
+}
+
+void terra::TileBatch::SetTexCoords(unsigned int First, const sf::Vector2<unsigned int> &TilePosition, const sf::Vector2<unsigned int> &Size, const sf::Vector2<unsigned int> &Offset, unsigned int Level){
+	// Tiles keep their row and column in downscaled tilesets, but shrink
+	sf::Vector2<unsigned int> Position = TilePosition;
+	sf::Vector2<unsigned int> TexSize = Size;
+	if (Level && Size.x && Size.y){
+		TexSize = TilesetLOD::GetTileSize(Size, Level);
+		Position = sf::Vector2<unsigned int>(TilePosition.x/Size.x*TexSize.x, TilePosition.y/Size.y*TexSize.y);
+	}
+
+	// Convert the position in the texture into texture coordinates for each corner
+	sf::FloatRect Coords = Texture->GetTexCoords(sf::IntRect(sf::Vector2<int>(Position+Offset), sf::Vector2<int>(TexSize)));
+	Vertices[First].TexCoords = sf::Vector2f(Coords.Left, Coords.Top);
+	Vertices[First+1].TexCoords = sf::Vector2f(Coords.Left, Coords.Top+Coords.Height);
+	Vertices[First+2].TexCoords = sf::Vector2f(Coords.Left+Coords.Width, Coords.Top+Coords.Height);
+	Vertices[First+3].TexCoords = sf::Vector2f(Coords.Left+Coords.Width, Coords.Top);
+}
+
+terra::TileBatch::~TileBatch(){
+}
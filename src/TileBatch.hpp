@@ -0,0 +1,127 @@
+#ifndef TERRA_TILEBATCH_HPP
+#define TERRA_TILEBATCH_HPP
+
+#include <list>
+#include <map>
+#include <memory>
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+#include "RenderBackend.hpp"
+#include "TextureAtlas.hpp"
+#include "Tile.hpp"
+#include "TileAnimator.hpp"
+#include "TileOcclusion.hpp"
+#include "TilesetLOD.hpp"
+#include "Vertex.hpp"
+
+namespace terra{
+	/*!
+	 * \brief A batch of tiles
+	 *
+	 * A batch of tiles which share a tileset. The geometry of every tile is kept in a single vertex list, so the whole batch can be drawn at once.
+	 */
+	class TileBatch{
+		private:
+			struct AnimatedTile{
+				unsigned int First;
+				unsigned int Animation;
+				sf::Vector2<unsigned int> Offset;
+				sf::Vector2<unsigned int> Size;
+				unsigned int Level;
+			};
+			std::shared_ptr<sf::Image> Texture;
+			std::vector<Vertex> Vertices;
+			std::vector<AnimatedTile> AnimatedTiles;
+			unsigned int AnimatedVersion;
+			sf::FloatRect Bounds;
+			void SetTexCoords(unsigned int First, const sf::Vector2<unsigned int> &TilePosition, const sf::Vector2<unsigned int> &Size, const sf::Vector2<unsigned int> &Offset, unsigned int Level);
+		public:
+			/*!
+			 * \param NewTexture The tileset shared by every tile in the batch
+			 *
+			 * Create a new, empty batch of tiles.
+			 */
+			TileBatch(std::shared_ptr<sf::Image> NewTexture);
+
+			/*!
+			 * \param NewTile The tile to add
+			 * \param Offset The position of the tile's tileset within the batch's texture
+			 * \param Level The level of detail of the batch's texture, where 0 is the full size tileset
+			 * \param Animations The animation table, or a null pointer if the tile isn't animated
+			 * \param Animation The index of the tile's animation in the table
+			 *
+			 * Add the geometry of a tile to the batch. Animated tiles are drawn with the animation's current frame.
+			 */
+			void AddTile(const Tile &NewTile, const sf::Vector2<unsigned int> &Offset = sf::Vector2<unsigned int>(0, 0), unsigned int Level = 0, const TileAnimator *Animations = nullptr, unsigned int Animation = 0);
+
+			/*!
+			 * \param Animations The animation table
+			 * \return True if any texture coordinates changed, false otherwise
+			 *
+			 * Point the texture coordinates of every animated tile in the batch at its animation's current frame. Does nothing unless an animation changed frames since the last call.
+			 */
+			bool Animate(const TileAnimator &Animations);
+
+			/*!
+			 * \param Tiles The tiles to sort into batches
+			 * \param Batches The batches to fill, keyed by texture
+			 * \param Atlas The atlas to draw tilesets from when they have been packed into it
+			 * \param Animations The table of animated tiles
+			 * \param LODs The downscaled tilesets
+			 * \param Level The level of detail to draw the tiles at, where 0 is full size
+			 * \param Occlusion The occlusion mask to leave hidden tiles out with, or a null pointer to keep every tile
+			 * \param Depth The depth of the tiles' layer in the occlusion mask
+			 *
+			 * Empty a set of batches, then refill them with a list of tiles, creating a new batch for each new texture. Below full size, tiles are drawn from their downscaled tileset when it has one and they, along with every frame they animate through, are exactly one cell of its grid. At full size, tiles from tilesets in the atlas are drawn from its pages, and all other tiles are drawn from their own tileset. Tiles hidden under opaque tiles of later layers are skipped.
+			 */
+			static void Build(const std::list<std::shared_ptr<Item>> &Tiles, std::map<const sf::Image *, std::shared_ptr<TileBatch>> &Batches, const TextureAtlas &Atlas, const TileAnimator &Animations, const TilesetLOD &LODs, unsigned int Level = 0, const TileOcclusion *Occlusion = nullptr, unsigned int Depth = 0);
+
+			/*!
+			 * Remove all tiles from the batch.
+			 */
+			void Clear();
+
+			/*!
+			 * \param Backend The backend to draw onto
+			 *
+			 * Draw every tile in the batch at once.
+			 */
+			void Draw(RenderBackend &Backend) const;
+
+			/*!
+			 * \return The area of the world covered by the batch
+			 *
+			 * Retrieve the smallest rectangle containing every tile in the batch.
+			 */
+			const sf::FloatRect &GetBounds() const;
+
+			/*!
+			 * \return True if any tile in the batch is animated, false otherwise
+			 *
+			 * Determines if the batch has animated tiles.
+			 */
+			const bool IsAnimated() const;
+
+			/*!
+			 * \return The number of tiles in the batch
+			 *
+			 * Retrieve the number of tiles in the batch.
+			 */
+			unsigned int GetTileCount() const;
+
+			/*!
+			 * \return The number of vertices in the batch
+			 *
+			 * Retrieve the number of vertices in the batch.
+			 */
+			unsigned int GetVertexCount() const;
+
+			/*!
+			 * Destroy the batch.
+			 */
+			~TileBatch();
+	};
+}
+
+#endif
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include "Engine.hpp"
+#include "TargetBackend.hpp"
+#include "TileChunk.hpp"
+
+terra::TileChunk::TileChunk(sf::Vector2f NewOrigin, unsigned int NewDepth){
+	Origin = NewOrigin;
+	Depth = NewDepth;
+	Dirty = true;
+	Level = 0;
+}
+
+void terra::TileChunk::AddTile(std::shared_ptr<terra::Item> NewTile){
+	Tiles.push_back(NewTile);
+	Dirty = true;
+}
+
+sf::FloatRect terra::TileChunk::GetBounds() const{
+	return sf::FloatRect(Origin.x, Origin.y, Size, Size);
+}
+
+unsigned int terra::TileChunk::GetTileCount() const{
+	return Tiles.size();
+}
+
+void terra::TileChunk::Invalidate(){
+	Dirty = true;
+}
+
+bool terra::TileChunk::IsEmpty() const{
+	return Tiles.empty();
+}
+
+void terra::TileChunk::Redraw(bool Cached){
+	// Rebuild the chunk's geometry
+	TileBatch::Build(Tiles, Batches, Engine::Get().GetAtlas(), Engine::Get().GetTileAnimator(), Engine::Get().GetTilesetLOD(), Level, &Engine::Get().GetTileOcclusion(), Depth);
+	Dirty = false;
+	if (!Cached){
+		Cache.reset();
+		return;
+	}
+	RedrawCache();
+}
+
+void terra::TileChunk::RedrawCache(){
+	// Create the cache the first time around, or when the level of detail changes its size
+	unsigned int CacheSize = std::max(Size >> Level, 1u);
+	if (!Cache || Cache->GetWidth() != CacheSize){
+		Cache.reset(new sf::RenderImage);
+		if (!Cache->Create(CacheSize, CacheSize)){
+			Cache.reset();
+			return;
+		}
+	}
+
+	// Draw the chunk's tiles with the chunk's corner at the origin of the image
+	// Tiles hanging over the edge of the chunk are clipped here and finished by the neighboring chunk
+	terra::TargetBackend CacheBackend(*Cache);
+	CacheBackend.SetView(sf::View(GetBounds()));
+	CacheBackend.Clear(sf::Color(0, 0, 0, 0));
+	for (auto i = Batches.begin(); i != Batches.end(); ++i)
+		i->second->Draw(CacheBackend);
+	Cache->Display();
+}
+
+void terra::TileChunk::RemoveTile(const std::shared_ptr<terra::Item> &OldTile){
+	for (auto i = Tiles.begin(); i != Tiles.end(); ++i){
+		if (*i == OldTile){
+			Tiles.erase(i);
+			Dirty = true;
+			return;
+		}
+	}
+}
+
+void terra::TileChunk::Render(terra::RenderBackend &Backend, unsigned int NewLevel){
+	if (NewLevel != Level){
+		Level = NewLevel;
+		Dirty = true;
+	}
+	if (Dirty)
+		Redraw(Backend.IsHardware());
+	else{
+		// Animated tiles only need their texture coordinates changed, but the cache has to be drawn again
+		bool Animated = false;
+		for (auto i = Batches.begin(); i != Batches.end(); ++i)
+			if (i->second->Animate(Engine::Get().GetTileAnimator()))
+				Animated = true;
+		if (Animated && Cache && Backend.IsHardware())
+			RedrawCache();
+	}
+
+	// Draw the batches directly if the cache couldn't be created or can't be used
+	if (!Cache || !Backend.IsHardware()){
+		for (auto i = Batches.begin(); i != Batches.end(); ++i)
+			i->second->Draw(Backend);
+		return;
+	}
+
+	// Otherwise blit the cache
+	terra::Vertex Corners[4];
+	sf::FloatRect Bounds = GetBounds();
+	sf::FloatRect Coords = Cache->GetImage().GetTexCoords(sf::IntRect(0, 0, Cache->GetWidth(), Cache->GetHeight()));
+	Corners[0].Position = sf::Vector2f(Bounds.Left, Bounds.Top);
+	Corners[0].TexCoords = sf::Vector2f(Coords.Left, Coords.Top);
+	Corners[1].Position = sf::Vector2f(Bounds.Left, Bounds.Top+Bounds.Height);
+	Corners[1].TexCoords = sf::Vector2f(Coords.Left, Coords.Top+Coords.Height);
+	Corners[2].Position = sf::Vector2f(Bounds.Left+Bounds.Width, Bounds.Top+Bounds.Height);
+	Corners[2].TexCoords = sf::Vector2f(Coords.Left+Coords.Width, Coords.Top+Coords.Height);
+	Corners[3].Position = sf::Vector2f(Bounds.Left+Bounds.Width, Bounds.Top);
+	Corners[3].TexCoords = sf::Vector2f(Coords.Left+Coords.Width, Coords.Top);
+	for (unsigned int i = 0; i < 4; ++i)
+		Corners[i].Color = sf::Color::White;
+	Backend.DrawQuads(&Cache->GetImage(), Corners, 4);
+}
+
+terra::TileChunk::~TileChunk(){
+}
@@ -0,0 +1,99 @@
+#ifndef TERRA_TILECHUNK_HPP
+#define TERRA_TILECHUNK_HPP
+
+#include <list>
+#include <map>
+#include <memory>
+#include <SFML/Graphics.hpp>
+#include <string>
+#include "Item.hpp"
+#include "RenderBackend.hpp"
+#include "TileBatch.hpp"
+
+namespace terra{
+	/*!
+	 * \brief A chunk of a static tile layer
+	 *
+	 * A square region of a static tile layer. The tiles inside of it are drawn into a cached image once, and the image is drawn in their place until one of them changes.
+	 */
+	class TileChunk{
+		private:
+			sf::Vector2f Origin;
+			unsigned int Depth;
+			std::list<std::shared_ptr<Item>> Tiles;
+			std::map<const sf::Image *, std::shared_ptr<TileBatch>> Batches;
+			std::shared_ptr<sf::RenderImage> Cache;
+			bool Dirty;
+			unsigned int Level;
+			void Redraw(bool Cached);
+			void RedrawCache();
+		public:
+			/*!
+			 * The width and height of every chunk, in pixels.
+			 */
+			static const unsigned int Size = 512;
+
+			/*!
+			 * \param NewOrigin The position of the chunk's top left corner in the world
+			 * \param NewDepth The depth of the chunk's layer, used to leave out tiles hidden by later layers
+			 *
+			 * Create a new, empty chunk.
+			 */
+			TileChunk(sf::Vector2f NewOrigin, unsigned int NewDepth = 0);
+
+			/*!
+			 * \param NewTile The tile to add
+			 *
+			 * Add a tile that overlaps the chunk.
+			 */
+			void AddTile(std::shared_ptr<Item> NewTile);
+
+			/*!
+			 * \return The area of the world covered by the chunk
+			 *
+			 * Retrieve the area of the world covered by the chunk.
+			 */
+			sf::FloatRect GetBounds() const;
+
+			/*!
+			 * \return The number of tiles overlapping the chunk
+			 *
+			 * Retrieve the number of tiles overlapping the chunk.
+			 */
+			unsigned int GetTileCount() const;
+
+			/*!
+			 * Force the cached image to be redrawn before the chunk is next rendered.
+			 */
+			void Invalidate();
+
+			/*!
+			 * \return True if the chunk has no tiles, false otherwise
+			 *
+			 * Check if the chunk is empty.
+			 */
+			bool IsEmpty() const;
+
+			/*!
+			 * \param OldTile The tile to remove
+			 *
+			 * Remove a tile from the chunk.
+			 */
+			void RemoveTile(const std::shared_ptr<Item> &OldTile);
+
+			/*!
+			 * \param Backend The backend to be rendered to
+			 * \param NewLevel The level of detail to draw the tiles at, where 0 is full size
+			 *
+			 * Render the chunk onto a backend, redrawing its cached image first if needed. Backends that don't use the graphics card are drawn the tiles themselves. The cached image shrinks along with the tiles when the level of detail drops.
+			 */
+			void Render(RenderBackend &Backend, unsigned int NewLevel = 0);
+
+			/*!
+			 * Destroy the chunk.
+			 */
+			~TileChunk();
+	};
+}
+
+#endif
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include "TileOcclusion.hpp"
+
+bool terra::TileOcclusion::Cell::operator<(const terra::TileOcclusion::Cell &Other) const{
+	if (Y != Other.Y)
+		return Y < Other.Y;
+	if (X != Other.X)
+		return X < Other.X;
+	if (Width != Other.Width)
+		return Width < Other.Width;
+	return Height < Other.Height;
+}
+
+terra::TileOcclusion::TileOcclusion(){
+}
+
+bool terra::TileOcclusion::AddTile(unsigned int Depth, const terra::Tile &NewTile){
+	if (Depth >= MaxDepth || !IsOpaque(NewTile))
+		return false;
+	unsigned long long &Layers = Mask[GetCell(NewTile)];
+	unsigned long long Bit = 1ull << Depth;
+	if (Layers & Bit)
+		return false;
+	Layers |= Bit;
+	return true;
+}
+
+void terra::TileOcclusion::AddTileset(const std::string &Name, const sf::Image &Tileset, unsigned int TileWidth, unsigned int TileHeight, const std::vector<terra::TileAnimation> &Animations){
+	if (!TileWidth || !TileHeight)
+		return;
+
+	// Check every pixel of every tile
+	TilesetOpacity Opacity;
+	Opacity.Columns = Tileset.GetWidth()/TileWidth;
+	Opacity.TileWidth = TileWidth;
+	Opacity.TileHeight = TileHeight;
+	unsigned int Rows = Tileset.GetHeight()/TileHeight;
+	Opacity.Opaque.assign(Opacity.Columns*Rows, true);
+	const sf::Uint8 *Pixels = Tileset.GetPixelsPtr();
+	for (unsigned int Y = 0; Y < Rows*TileHeight; ++Y)
+		for (unsigned int X = 0; X < Opacity.Columns*TileWidth; ++X)
+			if (Pixels[(Y*Tileset.GetWidth()+X)*4+3] != 255)
+				Opacity.Opaque[Y/TileHeight*Opacity.Columns+X/TileWidth] = false;
+
+	// Animated tiles can only hide things if they never show a transparent frame
+	for (auto i = Animations.begin(); i != Animations.end(); ++i){
+		bool Opaque = true;
+		for (auto j = i->Frames.begin(); j != i->Frames.end(); ++j){
+			unsigned int Index = j->y/TileHeight*Opacity.Columns+j->x/TileWidth;
+			if (j->x%TileWidth || j->y%TileHeight || j->x/TileWidth >= Opacity.Columns || Index >= Opacity.Opaque.size() || !Opacity.Opaque[Index])
+				Opaque = false;
+		}
+		unsigned int First = i->Frames[0].y/TileHeight*Opacity.Columns+i->Frames[0].x/TileWidth;
+		if (!Opaque && First < Opacity.Opaque.size())
+			Opacity.Opaque[First] = false;
+	}
+	Tilesets[Name] = Opacity;
+}
+
+void terra::TileOcclusion::Clear(){
+	Mask.clear();
+}
+
+terra::TileOcclusion::Cell terra::TileOcclusion::GetCell(const terra::Tile &TheTile){
+	Cell TileCell;
+	TileCell.X = TheTile.GetPosition().x;
+	TileCell.Y = TheTile.GetPosition().y;
+	TileCell.Width = TheTile.GetSize().x;
+	TileCell.Height = TheTile.GetSize().y;
+	return TileCell;
+}
+
+const bool terra::TileOcclusion::IsHidden(unsigned int Depth, const terra::Tile &TheTile) const{
+	if (Mask.empty() || Depth+1 >= MaxDepth)
+		return false;
+	auto Layers = Mask.find(GetCell(TheTile));
+	if (Layers == Mask.end())
+		return false;
+
+	// Look for any layer drawn after this one
+	return (Layers->second >> (Depth+1)) != 0;
+}
+
+const bool terra::TileOcclusion::IsOpaque(const terra::Tile &TheTile) const{
+	auto Opacity = Tilesets.find(TheTile.GetTileset());
+	if (Opacity == Tilesets.end())
+		return false;
+
+	// Only tiles that are exactly one cell of the tileset's grid are in the table
+	const TilesetOpacity &Table = Opacity->second;
+	sf::Vector2<unsigned int> Position = TheTile.GetTilePosition();
+	if (TheTile.GetSize().x != Table.TileWidth || TheTile.GetSize().y != Table.TileHeight || Position.x%Table.TileWidth || Position.y%Table.TileHeight || Position.x/Table.TileWidth >= Table.Columns)
+		return false;
+	unsigned int Index = Position.y/Table.TileHeight*Table.Columns+Position.x/Table.TileWidth;
+	return Index < Table.Opaque.size() && Table.Opaque[Index];
+}
+
+sf::FloatRect terra::TileOcclusion::RemoveLayer(unsigned int Depth){
+	sf::FloatRect Changed(0., 0., 0., 0.);
+	if (Depth >= MaxDepth)
+		return Changed;
+
+	// Clear the layer's bit everywhere, keeping track of the area it covered
+	unsigned long long Bit = 1ull << Depth;
+	bool First = true;
+	float Right = 0., Bottom = 0.;
+	for (auto i = Mask.begin(); i != Mask.end();){
+		if (!(i->second & Bit)){
+			++i;
+			continue;
+		}
+		if (First){
+			Changed.Left = i->first.X;
+			Changed.Top = i->first.Y;
+			Right = i->first.X+i->first.Width;
+			Bottom = i->first.Y+i->first.Height;
+			First = false;
+		}
+		else{
+			Changed.Left = std::min(Changed.Left, i->first.X);
+			Changed.Top = std::min(Changed.Top, i->first.Y);
+			Right = std::max(Right, i->first.X+i->first.Width);
+			Bottom = std::max(Bottom, i->first.Y+i->first.Height);
+		}
+		i->second &= ~Bit;
+		if (!i->second)
+			Mask.erase(i++);
+		else
+			++i;
+	}
+	if (!First){
+		Changed.Width = Right-Changed.Left;
+		Changed.Height = Bottom-Changed.Top;
+	}
+	return Changed;
+}
+
+bool terra::TileOcclusion::RemoveTile(unsigned int Depth, const terra::Tile &OldTile){
+	if (Depth >= MaxDepth || !IsOpaque(OldTile))
+		return false;
+	auto Layers = Mask.find(GetCell(OldTile));
+	unsigned long long Bit = 1ull << Depth;
+	if (Layers == Mask.end() || !(Layers->second & Bit))
+		return false;
+
+	// Another opaque tile in the same spot of the same layer would still hide things, but dropping the bit only ever makes more tiles drawn
+	Layers->second &= ~Bit;
+	if (!Layers->second)
+		Mask.erase(Layers);
+	return true;
+}
+
+terra::TileOcclusion::~TileOcclusion(){
+}
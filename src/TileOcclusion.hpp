@@ -0,0 +1,112 @@
+#ifndef TERRA_TILEOCCLUSION_HPP
+#define TERRA_TILEOCCLUSION_HPP
+
+#include <map>
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+#include "Tile.hpp"
+#include "TileAnimation.hpp"
+
+namespace terra{
+	/*!
+	 * \brief The occlusion mask of the tile layers
+	 *
+	 * Knows which tiles of every tileset are fully opaque, and where opaque tiles have been placed in each layer. A tile is hidden when an opaque tile covering exactly the same area sits in a layer drawn after it, so lower layers can leave it out of their geometry. The mask is updated one tile at a time as tiles are added and removed.
+	 */
+	class TileOcclusion{
+		private:
+			struct TilesetOpacity{
+				unsigned int Columns;
+				unsigned int TileWidth;
+				unsigned int TileHeight;
+				std::vector<bool> Opaque;
+			};
+			struct Cell{
+				float X;
+				float Y;
+				unsigned int Width;
+				unsigned int Height;
+				bool operator<(const Cell &Other) const;
+			};
+			std::map<std::string, TilesetOpacity> Tilesets;
+			std::map<Cell, unsigned long long> Mask;
+			static Cell GetCell(const Tile &TheTile);
+		public:
+			/*!
+			 * The number of layers that can hide the layers under them. Tiles in deeper layers are drawn as usual, but never hide anything.
+			 */
+			static const unsigned int MaxDepth = 64;
+
+			/*!
+			 * Create a new, empty occlusion mask.
+			 */
+			TileOcclusion();
+
+			/*!
+			 * \param Depth The depth of the tile's layer, counting up from the first layer drawn
+			 * \param NewTile The tile that was added
+			 * \return True if the mask changed, false otherwise
+			 *
+			 * Add a tile to the mask. Only opaque tiles change it.
+			 */
+			bool AddTile(unsigned int Depth, const Tile &NewTile);
+
+			/*!
+			 * \param Name The filename of the tileset
+			 * \param Tileset The tileset's image
+			 * \param TileWidth The width of the tileset's tiles
+			 * \param TileHeight The height of the tileset's tiles
+			 * \param Animations The tileset's animations, whose tiles are only opaque if every frame is
+			 *
+			 * Find which tiles of a tileset are fully opaque.
+			 */
+			void AddTileset(const std::string &Name, const sf::Image &Tileset, unsigned int TileWidth, unsigned int TileHeight, const std::vector<TileAnimation> &Animations);
+
+			/*!
+			 * Remove every tile from the mask, keeping the tilesets.
+			 */
+			void Clear();
+
+			/*!
+			 * \param Depth The depth of the tile's layer
+			 * \param TheTile The tile to check
+			 * \return True if an opaque tile in a later layer covers the tile, false otherwise
+			 *
+			 * Determines if a tile can't be seen.
+			 */
+			const bool IsHidden(unsigned int Depth, const Tile &TheTile) const;
+
+			/*!
+			 * \param TheTile The tile to check
+			 * \return True if every pixel of the tile is opaque, false otherwise
+			 *
+			 * Determines if a tile hides whatever is under it. Tiles that don't line up with their tileset's grid are never opaque.
+			 */
+			const bool IsOpaque(const Tile &TheTile) const;
+
+			/*!
+			 * \param Depth The depth of the layer
+			 * \return The area of the world that changed
+			 *
+			 * Remove every tile of a layer from the mask.
+			 */
+			sf::FloatRect RemoveLayer(unsigned int Depth);
+
+			/*!
+			 * \param Depth The depth of the tile's layer
+			 * \param OldTile The tile that was removed
+			 * \return True if the mask changed, false otherwise
+			 *
+			 * Remove a tile from the mask.
+			 */
+			bool RemoveTile(unsigned int Depth, const Tile &OldTile);
+
+			/*!
+			 * Destroy the occlusion mask.
+			 */
+			~TileOcclusion();
+	};
+}
+
+#endif
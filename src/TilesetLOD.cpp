@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cmath>
+#include "TilesetLOD.hpp"
+
+terra::TilesetLOD::TilesetLOD(){
+}
+
+void terra::TilesetLOD::Add(const std::string &Name, const sf::Image &Tileset, unsigned int TileWidth, unsigned int TileHeight){
+	if (!TileWidth || !TileHeight || Tileset.GetWidth() < TileWidth || Tileset.GetHeight() < TileHeight)
+		return;
+
+	// Keep halving until every tile is down to one pixel
+	std::vector<std::shared_ptr<sf::Image>> &TilesetLevels = Levels[Name];
+	TilesetLevels.clear();
+	Grids[Name] = std::make_pair(sf::Vector2<unsigned int>(TileWidth, TileHeight), sf::Vector2<unsigned int>(Tileset.GetWidth()/TileWidth, Tileset.GetHeight()/TileHeight));
+	for (unsigned int Level = 1; (TileWidth >> (Level-1)) > 1 || (TileHeight >> (Level-1)) > 1; ++Level)
+		TilesetLevels.push_back(Downsample(Tileset, TileWidth, TileHeight, Level));
+}
+
+unsigned int terra::TilesetLOD::ChooseLevel(float Scale){
+	// Tiles can shrink by half for every halving of the scale
+	if (Scale >= 1. || Scale <= 0.)
+		return 0;
+	return static_cast<unsigned int>(std::floor(std::log(1./Scale)/std::log(2.)));
+}
+
+void terra::TilesetLOD::Clear(){
+	Levels.clear();
+	Grids.clear();
+}
+
+std::shared_ptr<sf::Image> terra::TilesetLOD::Downsample(const sf::Image &Source, unsigned int TileWidth, unsigned int TileHeight, unsigned int Level){
+	// Each tile gets shrunk on its own
+	sf::Vector2<unsigned int> Size = GetTileSize(sf::Vector2<unsigned int>(TileWidth, TileHeight), Level);
+	unsigned int Columns = Source.GetWidth()/TileWidth;
+	unsigned int Rows = Source.GetHeight()/TileHeight;
+	unsigned int Width = Columns*Size.x;
+	unsigned int Height = Rows*Size.y;
+	const sf::Uint8 *SourcePixels = Source.GetPixelsPtr();
+	std::vector<sf::Uint8> Pixels(Width*Height*4);
+
+	for (unsigned int Y = 0; Y < Height; ++Y){
+		for (unsigned int X = 0; X < Width; ++X){
+			// Find the block of source pixels under this pixel, staying inside its tile
+			unsigned int TileX = X/Size.x*TileWidth;
+			unsigned int TileY = Y/Size.y*TileHeight;
+			unsigned int Left = TileX+X%Size.x*TileWidth/Size.x;
+			unsigned int Top = TileY+Y%Size.y*TileHeight/Size.y;
+			unsigned int Right = TileX+(X%Size.x+1)*TileWidth/Size.x;
+			unsigned int Bottom = TileY+(Y%Size.y+1)*TileHeight/Size.y;
+
+			// Average it, weighting colors by their opacity so transparent pixels don't darken the edges
+			unsigned long Red = 0, Green = 0, Blue = 0, Alpha = 0, Count = 0;
+			for (unsigned int SourceY = Top; SourceY < Bottom; ++SourceY){
+				for (unsigned int SourceX = Left; SourceX < Right; ++SourceX){
+					const sf::Uint8 *Pixel = SourcePixels+(SourceY*Source.GetWidth()+SourceX)*4;
+					Red += Pixel[0]*Pixel[3];
+					Green += Pixel[1]*Pixel[3];
+					Blue += Pixel[2]*Pixel[3];
+					Alpha += Pixel[3];
+					++Count;
+				}
+			}
+			sf::Uint8 *Pixel = &Pixels[(Y*Width+X)*4];
+			Pixel[0] = Alpha ? Red/Alpha : 0;
+			Pixel[1] = Alpha ? Green/Alpha : 0;
+			Pixel[2] = Alpha ? Blue/Alpha : 0;
+			Pixel[3] = Count ? Alpha/Count : 0;
+		}
+	}
+
+	std::shared_ptr<sf::Image> Result(new sf::Image);
+	Result->LoadFromPixels(Width, Height, &Pixels[0]);
+	return Result;
+}
+
+std::shared_ptr<sf::Image> terra::TilesetLOD::Find(const std::string &Name, unsigned int &Level) const{
+	auto TilesetLevels = Levels.find(Name);
+	if (!Level || TilesetLevels == Levels.end() || TilesetLevels->second.empty()){
+		Level = 0;
+		return std::shared_ptr<sf::Image>();
+	}
+	if (Level > TilesetLevels->second.size())
+		Level = TilesetLevels->second.size();
+	return TilesetLevels->second[Level-1];
+}
+
+sf::Vector2<unsigned int> terra::TilesetLOD::GetTileSize(const sf::Vector2<unsigned int> &Size, unsigned int Level){
+	return sf::Vector2<unsigned int>(std::max(Size.x >> Level, 1u), std::max(Size.y >> Level, 1u));
+}
+
+const bool terra::TilesetLOD::IsAligned(const std::string &Name, const sf::Vector2<unsigned int> &Position, const sf::Vector2<unsigned int> &Size) const{
+	// The downscaled tilesets only hold the whole cells of the grid
+	auto Grid = Grids.find(Name);
+	if (Grid == Grids.end())
+		return false;
+	const sf::Vector2<unsigned int> &TileSize = Grid->second.first;
+	const sf::Vector2<unsigned int> &Cells = Grid->second.second;
+	return Size == TileSize && Position.x%TileSize.x == 0 && Position.y%TileSize.y == 0 && Position.x/TileSize.x < Cells.x && Position.y/TileSize.y < Cells.y;
+}
+
+terra::TilesetLOD::~TilesetLOD(){
+}
@@ -0,0 +1,86 @@
+#ifndef TERRA_TILESETLOD_HPP
+#define TERRA_TILESETLOD_HPP
+
+#include <map>
+#include <memory>
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace terra{
+	/*!
+	 * \brief Downscaled tilesets
+	 *
+	 * Keeps smaller copies of every tileset for drawing zoomed out views. Each level of detail halves the size of every tile, averaging the pixels of each tile on its own so that neighboring tiles never bleed into each other, until every tile is a single pixel of its average color.
+	 */
+	class TilesetLOD{
+		private:
+			std::map<std::string, std::vector<std::shared_ptr<sf::Image>>> Levels;
+			std::map<std::string, std::pair<sf::Vector2<unsigned int>, sf::Vector2<unsigned int>>> Grids;
+			static std::shared_ptr<sf::Image> Downsample(const sf::Image &Source, unsigned int TileWidth, unsigned int TileHeight, unsigned int Level);
+		public:
+			/*!
+			 * Create a new, empty set of downscaled tilesets.
+			 */
+			TilesetLOD();
+
+			/*!
+			 * \param Name The name the tileset will be found under, usually its filename
+			 * \param Tileset The full size tileset
+			 * \param TileWidth The width of the tileset's tiles
+			 * \param TileHeight The height of the tileset's tiles
+			 *
+			 * Generate every level of detail of a tileset.
+			 */
+			void Add(const std::string &Name, const sf::Image &Tileset, unsigned int TileWidth, unsigned int TileHeight);
+
+			/*!
+			 * \param Scale The number of screen pixels covered by one unit of the world
+			 * \return The level of detail that is just large enough for the scale
+			 *
+			 * Choose the level of detail to draw at, where 0 is the full size tileset.
+			 */
+			static unsigned int ChooseLevel(float Scale);
+
+			/*!
+			 * Remove every tileset.
+			 */
+			void Clear();
+
+			/*!
+			 * \param Name The name of the tileset
+			 * \param Level The wanted level of detail, lowered to the smallest level the tileset has
+			 * \return The downscaled tileset, or a null pointer if the tileset has none or the level is 0
+			 *
+			 * Find a downscaled copy of a tileset.
+			 */
+			std::shared_ptr<sf::Image> Find(const std::string &Name, unsigned int &Level) const;
+
+			/*!
+			 * \param Size The full size of a tile
+			 * \param Level The level of detail
+			 * \return The size of the tile at that level of detail
+			 *
+			 * Find how big a tile is in a downscaled tileset.
+			 */
+			static sf::Vector2<unsigned int> GetTileSize(const sf::Vector2<unsigned int> &Size, unsigned int Level);
+
+			/*!
+			 * \param Name The name of the tileset
+			 * \param Position The position of the tile in the full size tileset
+			 * \param Size The size of the tile
+			 * \return True if the tile is exactly one cell of the tileset's grid, false otherwise
+			 *
+			 * Check if a tile can be drawn from the downscaled tilesets, which only keep whole cells of the grid.
+			 */
+			const bool IsAligned(const std::string &Name, const sf::Vector2<unsigned int> &Position, const sf::Vector2<unsigned int> &Size) const;
+
+			/*!
+			 * Destroy the set of downscaled tilesets.
+			 */
+			~TilesetLOD();
+	};
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef TERRA_TILESETPLAN_HPP
+#define TERRA_TILESETPLAN_HPP
+
+#include <SFML/System.hpp>
+#include <string>
+#include <vector>
+
+namespace terra{
+	/*!
+	 * \brief Tileset Parse Plan
+	 *
+	 * A structure containing everything the level parser needs to know about a tileset, worked out once when the project is parsed so that tiles can be parsed without looking anything up.
+	 */
+	struct TilesetPlan{
+		/*!
+		 * The filename of the tileset's image.
+		 */
+		std::string Image;
+
+		/*!
+		 * The size of the tileset's image.
+		 */
+		sf::Vector2<unsigned int> ImageSize;
+
+		/*!
+		 * The size of the tileset's tiles.
+		 */
+		sf::Vector2<unsigned int> TileSize;
+
+		/*!
+		 * The position in the tileset of the tile with each id, for tiles of the tileset's own size.
+		 */
+		std::vector<sf::Vector2<unsigned int>> Positions;
+	};
+}
+
+#endif
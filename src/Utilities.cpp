@@ -1,17 +1,52 @@
+#include <cerrno>
 #include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <map>
-#include <iterator>
+#include <sys/stat.h>
 #include "Engine.hpp"
+#include "InflateBuffer.hpp"
+#include "PackFile.hpp"
 #include "Utilities.hpp"
 
 std::string CurrentMusic;
 std::map<std::string, std::shared_ptr<sf::Music>> MusicMap;
 std::map<std::string, std::shared_ptr<sf::SoundBuffer>> SoundMap;
+std::vector<std::shared_ptr<terra::PackFile>> Packs;
 std::map<std::string, std::shared_ptr<sf::Image>> TextureMap;
 
+namespace{
+	bool IsLoose(const std::string &Filename){
+		struct stat Info;
+		return stat(Filename.c_str(), &Info) == 0;
+	}
+
+	// Loads images and sounds from loose files first, compressed or not, then from the packs
+	template <typename Resource> bool LoadResource(Resource &Target, const std::string &Name){
+		std::string Filename = terra::FindFile(Name);
+		if (IsLoose(Filename)){
+			if (!terra::IsCompressed(Filename))
+				return Target.LoadFromFile(Filename);
+			std::vector<char> Contents = terra::ReadFile(Filename);
+			return Contents.size() > 1 && Target.LoadFromMemory(&Contents[0], Contents.size()-1);
+		}
+
+		// Packed files are used straight out of the pack unless they are compressed
+		const terra::PackFile::Entry *Found;
+		const terra::PackFile *Pack = terra::FindPacked(Name, Found);
+		if (Pack == nullptr)
+			return Target.LoadFromFile(Filename);
+		if (!Found->Compressed)
+			return Target.LoadFromMemory(Pack->GetData(*Found), Found->Size);
+		std::vector<char> Contents;
+		return Pack->Extract(*Found, Contents) && Target.LoadFromMemory(&Contents[0], Found->Size);
+	}
+}
+
 std::list<unsigned int> terra::DetectConcavePoints(sf::Shape Shape){
 	// Calculate the center of the shape from its points
 	std::list<unsigned int> PointList;
@@ -53,11 +88,41 @@ std::list<unsigned int> terra::DetectConcavePoints(sf::Shape Shape){
 	return PointList;
 }
 
+std::string terra::FindFile(const std::string &Filename){
+	struct stat Info;
+	if (stat(Filename.c_str(), &Info) != 0 && stat((Filename+".gz").c_str(), &Info) == 0)
+		return Filename+".gz";
+	return Filename;
+}
+
+const terra::PackFile *terra::FindPacked(const std::string &Filename, const terra::PackFile::Entry *&Found){
+	// Packs mounted later override the ones before them
+	for (auto i = Packs.rbegin(); i != Packs.rend(); ++i)
+		if ((Found = (*i)->Find(Filename)) != nullptr)
+			return i->get();
+	Found = nullptr;
+	return nullptr;
+}
+
+unsigned long terra::GetFileSize(const std::string &Filename){
+	struct stat Info;
+	if (stat(Filename.c_str(), &Info) != 0)
+		return 0;
+	return Info.st_size;
+}
+
+std::time_t terra::GetModificationTime(const std::string &Filename){
+	struct stat Info;
+	if (stat(Filename.c_str(), &Info) != 0)
+		return 0;
+	return Info.st_mtime;
+}
+
 std::shared_ptr<sf::SoundBuffer> terra::GetSound(std::string SoundName){
 	// Standard Resource Loader
 	if (SoundMap.find(SoundName) == SoundMap.end()){
 		std::shared_ptr<sf::SoundBuffer> Temp(new sf::SoundBuffer);
-		if (!Temp->LoadFromFile(SoundName))
+		if (!LoadResource(*Temp, SoundName))
 			terra::Engine::Get().Error(std::string("Unable to load sound ") + SoundName + '\n');
 		SoundMap.insert(std::pair<std::string, std::shared_ptr<sf::SoundBuffer>>(SoundName, Temp));
 	}
@@ -68,13 +133,26 @@ std::shared_ptr<sf::Image> terra::GetTexture(std::string TextureName){
 	// Standard Resource Loader
 	if (TextureMap.find(TextureName) == TextureMap.end()){
 		std::shared_ptr<sf::Image> Temp(new sf::Image);
-		if (!Temp->LoadFromFile(TextureName))
+		if (!LoadResource(*Temp, TextureName))
 			terra::Engine::Get().Error(std::string("Unable to load texture ") + TextureName + '\n');
 		TextureMap.insert(std::pair<std::string, std::shared_ptr<sf::Image>>(TextureName, Temp));
 	}
 	return TextureMap.find(TextureName)->second;
 }
 
+sf::FloatRect terra::GetViewRect(const sf::View &View){
+	return sf::FloatRect(View.GetCenter().x-View.GetSize().x/2., View.GetCenter().y-View.GetSize().y/2., View.GetSize().x, View.GetSize().y);
+}
+
+uint64_t terra::HashData(const char *Data, unsigned long Size){
+	uint64_t Hash = 14695981039346656037ULL;
+	for (const char *i = Data; i != Data+Size; ++i){
+		Hash ^= static_cast<unsigned char>(*i);
+		Hash *= 1099511628211ULL;
+	}
+	return Hash;
+}
+
 bool terra::IsBigEndian(){
 	// I cheated. So sue me.
 	int16_t One = 1;
@@ -144,6 +222,70 @@ bool terra::IsColliding(sf::Shape A, sf::Shape B){
 	return true;
 }
 
+bool terra::IsCompressed(const std::string &Filename){
+	return Filename.size() > 3 && Filename.compare(Filename.size()-3, 3, ".gz") == 0;
+}
+
+bool terra::MountPack(const std::string &Filename){
+	std::shared_ptr<terra::PackFile> Pack(new terra::PackFile);
+	std::string Problem;
+	if (!Pack->Open(Filename, Problem)){
+		terra::Engine::Get().Error(std::string("Unable to mount \"") + Filename + "\": " + Problem + '\n');
+		return false;
+	}
+	Packs.push_back(Pack);
+	return true;
+}
+
+int terra::ParseInteger(const char *String){
+	// Skip the whitespace and sign
+	while (*String == ' ' || *String == '\t' || *String == '\n' || *String == '\r')
+		++String;
+	bool Negative = *String == '-';
+	if (*String == '-' || *String == '+')
+		++String;
+
+	// Then just add up the digits, in a wider type that stops growing once it is out of range so it can't overflow
+	const long long Limit = static_cast<long long>(std::numeric_limits<int>::max())+1;
+	long long Value = 0;
+	for (; *String >= '0' && *String <= '9'; ++String)
+		if (Value <= Limit)
+			Value = Value*10+(*String-'0');
+
+	// Clamp whatever doesn't fit, like strtol() does
+	if (Negative)
+		return -Value < std::numeric_limits<int>::min() ? std::numeric_limits<int>::min() : static_cast<int>(-Value);
+	return Value > std::numeric_limits<int>::max() ? std::numeric_limits<int>::max() : static_cast<int>(Value);
+}
+
+float terra::ParseNumber(const char *String){
+	// Skip the whitespace and sign
+	const char *Start = String;
+	while (*String == ' ' || *String == '\t' || *String == '\n' || *String == '\r')
+		++String;
+	bool Negative = *String == '-';
+	if (*String == '-' || *String == '+')
+		++String;
+
+	// Add up the digits on both sides of the point, then scale them down by the ones after it
+	double Value = 0.;
+	for (; *String >= '0' && *String <= '9'; ++String)
+		Value = Value*10.+(*String-'0');
+	if (*String == '.'){
+		double Scale = 1.;
+		for (++String; *String >= '0' && *String <= '9'; ++String){
+			Value = Value*10.+(*String-'0');
+			Scale *= 10.;
+		}
+		Value /= Scale;
+	}
+
+	// Exponents are rare enough to leave to the standard library
+	if (*String == 'e' || *String == 'E')
+		return atof(Start);
+	return Negative ? -Value : Value;
+}
+
 void terra::PauseMusic(){
 	// Yay hidden stuff
 	if (CurrentMusic.size())
@@ -171,25 +313,88 @@ void terra::PlayMusic(std::string MusicName, bool Loop, bool Pause){
 }
 
 std::vector<char> terra::ReadFile(std::string Filename){
-	// Open the file
-	std::ifstream FileStream(Filename);
+	// Compressed files are inflated a chunk at a time, since their size isn't known up front
+	std::vector<char> Contents(1, 0);
+	Filename = terra::FindFile(Filename);
+	if (terra::IsCompressed(Filename)){
+		std::ifstream FileStream(Filename.c_str(), std::ios::binary);
+		if (!FileStream){
+			terra::Engine::Get().Error(std::string("Unable to open \"") + Filename + "\": " + strerror(errno) + '\n');
+			return Contents;
+		}
+		terra::InflateBuffer Inflater(FileStream);
+		std::istream Decompressed(&Inflater);
+		Contents.clear();
+		std::vector<char> Chunk(65536);
+		while (Decompressed.read(&Chunk[0], Chunk.size()) || Decompressed.gcount() > 0)
+			Contents.insert(Contents.end(), Chunk.begin(), Chunk.begin()+Decompressed.gcount());
+		if (Inflater.HasFailed()){
+			terra::Engine::Get().Error(std::string("Unable to decompress \"") + Filename + "\": " + Inflater.GetError() + '\n');
+			Contents.clear();
+		}
+		Contents.push_back(0);
+		return Contents;
+	}
 
-	// Copy file contents to a vector
-	FileStream >> std::noskipws;
-	std::vector<char> String;
-	std::copy(std::istream_iterator<char>(FileStream), std::istream_iterator<char>(), std::back_inserter(String));
+	// Files that aren't loose come out of the packs
+	const terra::PackFile::Entry *Found;
+	const terra::PackFile *Pack;
+	if (!IsLoose(Filename) && (Pack = terra::FindPacked(Filename, Found)) != nullptr){
+		if (!Pack->Extract(*Found, Contents))
+			terra::Engine::Get().Error(std::string("Unable to read \"") + Filename + "\" from its pack\n");
+		return Contents;
+	}
+
+	// Find the size first so the whole file can be read at once
+	struct stat Info;
+	if (stat(Filename.c_str(), &Info) != 0){
+		terra::Engine::Get().Error(std::string("Unable to read \"") + Filename + "\": " + strerror(errno) + '\n');
+		return Contents;
+	}
+
+	// Read it in one go, leaving the null character on the end
+	std::ifstream FileStream(Filename.c_str(), std::ios::binary);
+	if (!FileStream){
+		terra::Engine::Get().Error(std::string("Unable to open \"") + Filename + "\": " + strerror(errno) + '\n');
+		return Contents;
+	}
+	Contents.resize(Info.st_size+1, 0);
+	FileStream.read(&Contents[0], Info.st_size);
 
 	// Abort if an error occurred
-	if (!FileStream.good()){
+	if (FileStream.bad()){
 		terra::Engine::Get().Error(std::string("Unexpected error occured when reading \"") + Filename + "\"\n");
-		FileStream.close();
-		String.resize(0);
-		String.push_back(0);
-		return String;
+		Contents.assign(1, 0);
+		return Contents;
 	}
 
-	FileStream.close();
-	return String;
+	// The file may have shrunk since it was measured
+	Contents.resize(FileStream.gcount()+1);
+	Contents.back() = 0;
+	return Contents;
+}
+
+bool terra::ReadFile(const std::string &Filename, terra::MappedFile &Contents){
+	// Compressed and packed files can't be mapped on their own, so they are read into the mapping's buffer
+	std::string Found = terra::FindFile(Filename);
+	const terra::PackFile::Entry *Entry;
+	if (terra::IsCompressed(Found) || (!IsLoose(Found) && terra::FindPacked(Found, Entry) != nullptr)){
+		std::vector<char> Decompressed = terra::ReadFile(Found);
+		Contents.Adopt(Decompressed);
+		return Contents.GetSize() > 0;
+	}
+
+	// Find out why the file is missing before trying to map it
+	struct stat Info;
+	if (stat(Filename.c_str(), &Info) != 0){
+		terra::Engine::Get().Error(std::string("Unable to read \"") + Filename + "\": " + strerror(errno) + '\n');
+		return false;
+	}
+	if (!Contents.Open(Filename, true)){
+		terra::Engine::Get().Error(std::string("Unable to map \"") + Filename + "\" into memory\n");
+		return false;
+	}
+	return true;
 }
 
 void terra::StopMusic(){
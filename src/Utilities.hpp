@@ -5,8 +5,12 @@
 #include <memory>
 #include <SFML/Audio.hpp>
 #include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <ctime>
 #include <string>
 #include <vector>
+#include "MappedFile.hpp"
+#include "PackFile.hpp"
 
 namespace terra{
 	/*!
@@ -17,6 +21,39 @@ namespace terra{
 	 */
 	std::list<unsigned int> DetectConcavePoints(sf::Shape Shape);
 
+	/*!
+	 * \param Filename The name of the file
+	 * \return The name of the file to read, which is the file itself, or its gzip compressed copy if only that exists
+	 *
+	 * Find the file to read for a filename. Any file can be shipped compressed by gzipping it and adding ".gz" to its name.
+	 */
+	std::string FindFile(const std::string &Filename);
+
+	/*!
+	 * \param Filename The name of the file
+	 * \param Found Set to the file's entry in the pack, or a null pointer if no pack has it
+	 * \return The pack holding the file, or a null pointer if no pack has it
+	 *
+	 * Find a file in the mounted packs, searching the most recently mounted first.
+	 */
+	const PackFile *FindPacked(const std::string &Filename, const PackFile::Entry *&Found);
+
+	/*!
+	 * \param Filename The name of the file
+	 * \return The size of the file in bytes, or 0 if it doesn't exist
+	 *
+	 * Find out how large a file is without opening it.
+	 */
+	unsigned long GetFileSize(const std::string &Filename);
+
+	/*!
+	 * \param Filename The name of the file
+	 * \return The time the file was last modified, or 0 if it doesn't exist
+	 *
+	 * Find out when a file was last modified.
+	 */
+	std::time_t GetModificationTime(const std::string &Filename);
+
 	/*!
 	 * \param SoundName The filename of the sound
 	 * \return A reference to the sound
@@ -33,6 +70,23 @@ namespace terra{
 	 */
 	std::shared_ptr<sf::Image> GetTexture(std::string TextureName);
 
+	/*!
+	 * \param View The view to measure
+	 * \return The area of the world shown by the view
+	 *
+	 * Calculate the area of the world that a view shows, ignoring any rotation.
+	 */
+	sf::FloatRect GetViewRect(const sf::View &View);
+
+	/*!
+	 * \param Data The bytes to hash
+	 * \param Size The number of bytes
+	 * \return The 64 bit FNV-1a hash of the bytes
+	 *
+	 * Hash a block of memory. Fast, but not meant to stand up to anyone trying to make collisions.
+	 */
+	uint64_t HashData(const char *Data, unsigned long Size);
+
 	/*!
 	 * \return True if the system is Big Endian, false if the system is Little Endian
 	 *
@@ -40,6 +94,14 @@ namespace terra{
 	 */
 	bool IsBigEndian();
 
+	/*!
+	 * \param Filename The name of the file
+	 * \return True if the name ends with ".gz", false otherwise
+	 *
+	 * Determines if a file is gzip compressed, going by its name.
+	 */
+	bool IsCompressed(const std::string &Filename);
+
 	/*!
 	 * \param A A convex polygon
 	 * \param B Another convex polygon
@@ -49,6 +111,30 @@ namespace terra{
 	 */
 	bool IsColliding(sf::Shape A, sf::Shape B);
 
+	/*!
+	 * \param Filename The filename of the pack
+	 * \return True if the pack was mounted, false otherwise
+	 *
+	 * Mount a pack made by terra_pack, so its files can be read as if they were loose. Loose files always override packed ones, and packs mounted later override earlier ones.
+	 */
+	bool MountPack(const std::string &Filename);
+
+	/*!
+	 * \param String The text of an integer
+	 * \return The integer, or 0 if the text doesn't start with one
+	 *
+	 * Quickly read an integer from text, like atoi() does but without locale handling. Integers too large for an int are clamped to its range.
+	 */
+	int ParseInteger(const char *String);
+
+	/*!
+	 * \param String The text of a number
+	 * \return The number, or 0 if the text doesn't start with one
+	 *
+	 * Quickly read a decimal number from text, like atof() does but without locale handling. Numbers with exponents are handed over to atof().
+	 */
+	float ParseNumber(const char *String);
+
 	/*!
 	 * Pause any music which is currently playing.
 	 */
@@ -65,12 +151,21 @@ namespace terra{
 
 	/*!
 	 * \param Filename The name of the file to read from
-	 * \return The contents of the file
+	 * \return The contents of the file, followed by a null character
 	 *
-	 * Read in the contents of a file.
+	 * Read in the contents of a file with a single read. The null character on the end is part of the vector, so the contents can be handed to parsers that need a C string. Compressed files, and files that only exist compressed, are decompressed as they are read, and files that aren't loose are read from the mounted packs. If the file can't be read, an error is sent to the console and the vector only holds the null character.
 	 */
 	std::vector<char> ReadFile(std::string Filename);
 
+	/*!
+	 * \param Filename The name of the file to read from
+	 * \param Contents The mapping to open the file in
+	 * \return True if the file was mapped, false otherwise
+	 *
+	 * Map a file into memory copy-on-write and null-terminated, so a parser can work on it in place without it being copied first. Compressed and packed files can't be mapped on their own, so they are read into the mapping's buffer instead. If the file can't be read, an error is sent to the console.
+	 */
+	bool ReadFile(const std::string &Filename, MappedFile &Contents);
+
 	/*!
 	 * Stop any music which is currently playing.
 	 */
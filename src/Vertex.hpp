@@ -0,0 +1,30 @@
+#ifndef TERRA_VERTEX_HPP
+#define TERRA_VERTEX_HPP
+
+#include <SFML/Graphics.hpp>
+
+namespace terra{
+	/*!
+	 * \brief A Vertex
+	 *
+	 * A single textured vertex, as stored in the engine's batched geometry.
+	 */
+	struct Vertex{
+		/*!
+		 * The position of the vertex in the world.
+		 */
+		sf::Vector2f Position;
+
+		/*!
+		 * The normalized texture coordinates of the vertex.
+		 */
+		sf::Vector2f TexCoords;
+
+		/*!
+		 * The color the texture is multiplied by at the vertex.
+		 */
+		sf::Color Color;
+	};
+}
+
+#endif
@@ -0,0 +1,330 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "XMLReader.hpp"
+
+namespace{
+	bool IsSpace(char Character){
+		return Character == ' ' || Character == '\t' || Character == '\n' || Character == '\r';
+	}
+}
+
+terra::XMLReader::XMLReader(std::istream &NewSource, unsigned int BufferSize) : Source(NewSource){
+	Buffer.resize(BufferSize > 16 ? BufferSize : 16);
+	Begin = 0;
+	Depth = 0;
+	Filled = 0;
+	Finished = false;
+	Name = nullptr;
+	PendingEnd = false;
+}
+
+void terra::XMLReader::Decode(char *String){
+	// Entities only ever get shorter, so they can be decoded in place
+	char *Write = String;
+	for (char *Read = String; *Read != 0;){
+		if (*Read != '&'){
+			*Write++ = *Read++;
+			continue;
+		}
+		char *Semicolon = strchr(Read, ';');
+		if (Semicolon == nullptr){
+			*Write++ = *Read++;
+			continue;
+		}
+		std::string Entity(Read+1, Semicolon);
+		unsigned long Code = 0;
+		if (Entity == "amp")
+			Code = '&';
+		else if (Entity == "lt")
+			Code = '<';
+		else if (Entity == "gt")
+			Code = '>';
+		else if (Entity == "quot")
+			Code = '"';
+		else if (Entity == "apos")
+			Code = '\'';
+		else if (Entity.size() > 1 && Entity[0] == '#')
+			Code = Entity[1] == 'x' ? strtoul(Entity.c_str()+2, nullptr, 16) : strtoul(Entity.c_str()+1, nullptr, 10);
+
+		// Leave unknown entities alone, and write the rest out as UTF-8
+		if (Code == 0){
+			*Write++ = *Read++;
+			continue;
+		}
+		if (Code < 0x80)
+			*Write++ = Code;
+		else if (Code < 0x800){
+			*Write++ = 0xC0 | (Code >> 6);
+			*Write++ = 0x80 | (Code & 0x3F);
+		}
+		else if (Code < 0x10000){
+			*Write++ = 0xE0 | (Code >> 12);
+			*Write++ = 0x80 | ((Code >> 6) & 0x3F);
+			*Write++ = 0x80 | (Code & 0x3F);
+		}
+		else{
+			*Write++ = 0xF0 | (Code >> 18);
+			*Write++ = 0x80 | ((Code >> 12) & 0x3F);
+			*Write++ = 0x80 | ((Code >> 6) & 0x3F);
+			*Write++ = 0x80 | (Code & 0x3F);
+		}
+		Read = Semicolon+1;
+	}
+	*Write = 0;
+}
+
+terra::XMLReader::EventType terra::XMLReader::Fail(const std::string &Why){
+	Problem = Why;
+	return Error;
+}
+
+bool terra::XMLReader::Find(const char *Sequence, size_t &Offset){
+	// Offsets are from the start of the current token, since refilling moves it
+	size_t Length = strlen(Sequence);
+	while (true){
+		char *Start = &Buffer[Begin];
+		char *Stop = &Buffer[0]+Filled;
+		char *Found = std::search(Start+std::min(Offset, Filled-Begin), Stop, Sequence, Sequence+Length);
+		if (Found != Stop){
+			Offset = Found-Start;
+			return true;
+		}
+
+		// Pick up where this search left off, in case the sequence was split between reads
+		size_t Searched = Filled-Begin;
+		Offset = std::max(Offset, Searched >= Length ? Searched-Length+1 : 0);
+		if (!Refill())
+			return false;
+	}
+}
+
+bool terra::XMLReader::FindTagEnd(size_t &Offset){
+	// Look for the closing bracket, skipping any inside quoted attribute values
+	char Quote = 0;
+	while (true){
+		for (; Begin+Offset < Filled; ++Offset){
+			char Character = Buffer[Begin+Offset];
+			if (Quote != 0){
+				if (Character == Quote)
+					Quote = 0;
+			}
+			else if (Character == '"' || Character == '\'')
+				Quote = Character;
+			else if (Character == '>')
+				return true;
+		}
+		if (!Refill())
+			return false;
+	}
+}
+
+const char *terra::XMLReader::GetAttribute(const char *AttributeName) const{
+	for (auto i = Attributes.begin(); i != Attributes.end(); ++i)
+		if (strcmp(i->first, AttributeName) == 0)
+			return i->second;
+	return nullptr;
+}
+
+const unsigned int terra::XMLReader::GetAttributeCount() const{
+	return Attributes.size();
+}
+
+const char *terra::XMLReader::GetAttributeName(unsigned int Index) const{
+	return Attributes[Index].first;
+}
+
+const char *terra::XMLReader::GetAttributeValue(unsigned int Index) const{
+	return Attributes[Index].second;
+}
+
+const unsigned int terra::XMLReader::GetDepth() const{
+	return Depth;
+}
+
+const std::string &terra::XMLReader::GetError() const{
+	return Problem;
+}
+
+const char *terra::XMLReader::GetName() const{
+	return Name;
+}
+
+const std::string &terra::XMLReader::GetText() const{
+	return TextData;
+}
+
+terra::XMLReader::EventType terra::XMLReader::Next(){
+	// The second half of an empty element
+	if (PendingEnd){
+		PendingEnd = false;
+		--Depth;
+		return EndElement;
+	}
+	Attributes.clear();
+	Name = nullptr;
+
+	while (true){
+		// Make sure there's something to look at
+		if (Begin == Filled && !Refill()){
+			if (!Source.eof())
+				return Fail("unable to read the stream");
+			return Depth == 0 ? End : Fail("the document ended inside an element");
+		}
+
+		// Text runs up to the next tag
+		if (Buffer[Begin] != '<'){
+			size_t Length = 0;
+			while (true){
+				char *Found = std::find(&Buffer[Begin]+Length, &Buffer[0]+Filled, '<');
+				Length = Found-&Buffer[Begin];
+				if (Begin+Length < Filled || !Refill())
+					break;
+			}
+			TextData.assign(&Buffer[Begin], Length);
+			Begin += Length;
+			// Whitespace, and anything outside the root element like a byte order mark, is left out
+			if (Depth == 0 || std::find_if(TextData.begin(), TextData.end(), [](char Character){ return !IsSpace(Character); }) == TextData.end())
+				continue;
+			Decode(&TextData[0]);
+			TextData.resize(strlen(TextData.c_str()));
+			return Text;
+		}
+
+		// Read far enough ahead to tell the kinds of tags apart
+		while (Filled-Begin < 9 && Refill());
+		const char *Tag = &Buffer[Begin];
+		size_t Available = Filled-Begin;
+
+		// Comments, processing instructions, and doctypes are skipped
+		size_t Offset;
+		if (Available >= 4 && strncmp(Tag, "<!--", 4) == 0){
+			Offset = 4;
+			if (!Find("-->", Offset))
+				return Fail("unterminated comment");
+			Begin += Offset+3;
+			continue;
+		}
+		if (Available >= 2 && strncmp(Tag, "<?", 2) == 0){
+			Offset = 2;
+			if (!Find("?>", Offset))
+				return Fail("unterminated processing instruction");
+			Begin += Offset+2;
+			continue;
+		}
+
+		// Character data is text which is never decoded
+		if (Available >= 9 && strncmp(Tag, "<![CDATA[", 9) == 0){
+			Offset = 9;
+			if (!Find("]]>", Offset))
+				return Fail("unterminated character data");
+			TextData.assign(&Buffer[Begin]+9, Offset-9);
+			Begin += Offset+3;
+			if (Depth == 0)
+				return Fail("character data outside of the root element");
+			return Text;
+		}
+		if (Available >= 2 && strncmp(Tag, "<!", 2) == 0){
+			Offset = 2;
+			if (!Find(">", Offset))
+				return Fail("unterminated declaration");
+			Begin += Offset+1;
+			continue;
+		}
+
+		// End tags
+		if (Available >= 2 && Tag[1] == '/'){
+			Offset = 2;
+			if (!Find(">", Offset))
+				return Fail("unterminated end tag");
+			if (Depth == 0)
+				return Fail("end tag without a start tag");
+			char *Start = &Buffer[Begin]+2;
+			char *Stop = &Buffer[Begin]+Offset;
+			while (Stop > Start && IsSpace(Stop[-1]))
+				--Stop;
+			*Stop = 0;
+			Name = Start;
+			Begin += Offset+1;
+			--Depth;
+			return EndElement;
+		}
+
+		// Start tags, parsed in place
+		Offset = 1;
+		if (!FindTagEnd(Offset))
+			return Fail("unterminated start tag");
+		char *Read = &Buffer[Begin]+1;
+		char *Stop = &Buffer[Begin]+Offset;
+		Begin += Offset+1;
+		*Stop = 0;
+		if (Stop > Read && Stop[-1] == '/'){
+			PendingEnd = true;
+			*--Stop = 0;
+		}
+
+		// The name runs up to the first space
+		Name = Read;
+		while (Read < Stop && !IsSpace(*Read))
+			++Read;
+		if (Read == Name)
+			return Fail("start tag without a name");
+		if (Read < Stop)
+			*Read++ = 0;
+
+		// Then come the attributes
+		while (true){
+			while (Read < Stop && IsSpace(*Read))
+				++Read;
+			if (Read >= Stop)
+				break;
+			char *AttributeName = Read;
+			while (Read < Stop && *Read != '=' && !IsSpace(*Read))
+				++Read;
+			char *NameEnd = Read;
+			while (Read < Stop && IsSpace(*Read))
+				++Read;
+			if (Read >= Stop || *Read != '=')
+				return Fail(std::string("attribute without a value in \"") + Name + "\"");
+			++Read;
+			while (Read < Stop && IsSpace(*Read))
+				++Read;
+			if (Read >= Stop || (*Read != '"' && *Read != '\''))
+				return Fail(std::string("unquoted attribute value in \"") + Name + "\"");
+			char Quote = *Read++;
+			char *Value = Read;
+			while (Read < Stop && *Read != Quote)
+				++Read;
+			if (Read >= Stop)
+				return Fail(std::string("unterminated attribute value in \"") + Name + "\"");
+			*NameEnd = 0;
+			*Read++ = 0;
+			Decode(Value);
+			Attributes.push_back(std::make_pair(AttributeName, Value));
+		}
+		++Depth;
+		return StartElement;
+	}
+}
+
+bool terra::XMLReader::Refill(){
+	if (Finished)
+		return false;
+
+	// Move what is left of the current token to the front, and make room if the token fills the whole buffer
+	if (Begin > 0){
+		memmove(&Buffer[0], &Buffer[Begin], Filled-Begin);
+		Filled -= Begin;
+		Begin = 0;
+	}
+	if (Filled == Buffer.size())
+		Buffer.resize(Buffer.size()*2);
+
+	// Read as much as fits
+	Source.read(&Buffer[Filled], Buffer.size()-Filled);
+	size_t Read = Source.gcount();
+	Filled += Read;
+	if (!Source)
+		Finished = true;
+	return Read > 0;
+}
@@ -0,0 +1,125 @@
+#ifndef TERRA_XMLREADER_HPP
+#define TERRA_XMLREADER_HPP
+
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace terra{
+	/*!
+	 * \brief Streaming XML reader
+	 *
+	 * A pull parser which reads XML from a stream one event at a time, through a buffer that only has to hold the largest single tag or run of text. Nothing is built up as the document is read, so documents of any size can be parsed in bounded memory.
+	 *
+	 * Names, attributes, and text are parsed in place in the buffer, and stay valid until the next call to Next(). Comments, processing instructions, and doctypes are skipped, entities are decoded, and text that is only whitespace is left out.
+	 */
+	class XMLReader{
+		public:
+			/*!
+			 * An enumeration of the things Next() can find.
+			 */
+			enum EventType{
+				StartElement,
+				EndElement,
+				Text,
+				End,
+				Error
+			};
+		private:
+			std::vector<std::pair<char *, char *>> Attributes;
+			std::vector<char> Buffer;
+			size_t Begin;
+			unsigned int Depth;
+			size_t Filled;
+			bool Finished;
+			char *Name;
+			bool PendingEnd;
+			std::string Problem;
+			std::istream &Source;
+			std::string TextData;
+			static void Decode(char *String);
+			EventType Fail(const std::string &Why);
+			bool Find(const char *Sequence, size_t &Offset);
+			bool FindTagEnd(size_t &Offset);
+			bool Refill();
+			XMLReader(const XMLReader &Copy);
+			XMLReader &operator=(const XMLReader &Copy);
+		public:
+			/*!
+			 * \param NewSource The stream to read from, which must outlive the reader
+			 * \param BufferSize The starting size of the buffer, which only grows for tags or text larger than it
+			 *
+			 * Create a new reader at the start of a stream.
+			 */
+			XMLReader(std::istream &NewSource, unsigned int BufferSize = 65536);
+
+			/*!
+			 * \param AttributeName The name of the attribute
+			 * \return The value of the attribute, or a null pointer if the element doesn't have it
+			 *
+			 * Find an attribute of the current element by name.
+			 */
+			const char *GetAttribute(const char *AttributeName) const;
+
+			/*!
+			 * \return The number of attributes the current element has
+			 *
+			 * Retrieve the number of attributes of the current element. Only start elements have attributes.
+			 */
+			const unsigned int GetAttributeCount() const;
+
+			/*!
+			 * \param Index The index of the attribute
+			 * \return The name of the attribute
+			 *
+			 * Retrieve the name of one of the current element's attributes.
+			 */
+			const char *GetAttributeName(unsigned int Index) const;
+
+			/*!
+			 * \param Index The index of the attribute
+			 * \return The value of the attribute
+			 *
+			 * Retrieve the value of one of the current element's attributes.
+			 */
+			const char *GetAttributeValue(unsigned int Index) const;
+
+			/*!
+			 * \return The number of elements that are open, counting the current start element
+			 *
+			 * Retrieve how deep in the document the reader is. The root element is at depth 1.
+			 */
+			const unsigned int GetDepth() const;
+
+			/*!
+			 * \return A description of what went wrong, if Next() found an error
+			 *
+			 * Retrieve the reason the document couldn't be read.
+			 */
+			const std::string &GetError() const;
+
+			/*!
+			 * \return The name of the current element
+			 *
+			 * Retrieve the name of the element that was just started or ended.
+			 */
+			const char *GetName() const;
+
+			/*!
+			 * \return The current text
+			 *
+			 * Retrieve the text that was just read.
+			 */
+			const std::string &GetText() const;
+
+			/*!
+			 * \return What was found
+			 *
+			 * Read up to the next start element, end element, or text. Empty elements give a start element followed by an end element.
+			 */
+			EventType Next();
+	};
+}
+
+#endif
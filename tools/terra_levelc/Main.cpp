@@ -0,0 +1,5 @@
+#include "Engine.hpp"
+
+int main(int argc, char *argv[]){
+	return terra::Engine::Get().CompileLevels(argc, argv);
+}
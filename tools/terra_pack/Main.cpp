@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+#include "PackFile.hpp"
+
+// Add a file, or every file under a directory, to the list of files to pack
+void AddFiles(const std::string &Path, std::vector<std::string> &Files){
+	struct stat Info;
+	if (stat(Path.c_str(), &Info) != 0){
+		std::cerr << "Unable to find \"" << Path << "\"" << std::endl;
+		return;
+	}
+	if (!(Info.st_mode & S_IFDIR)){
+		Files.push_back(Path);
+		return;
+	}
+#ifdef _WIN32
+	WIN32_FIND_DATAA Found;
+	HANDLE Search = FindFirstFileA((Path+"/*").c_str(), &Found);
+	if (Search == INVALID_HANDLE_VALUE)
+		return;
+	do{
+		std::string Name = Found.cFileName;
+		if (Name != "." && Name != "..")
+			AddFiles(Path+"/"+Name, Files);
+	} while (FindNextFileA(Search, &Found));
+	FindClose(Search);
+#else
+	DIR *Directory = opendir(Path.c_str());
+	if (Directory == nullptr)
+		return;
+	for (dirent *Found = readdir(Directory); Found != nullptr; Found = readdir(Directory)){
+		std::string Name = Found->d_name;
+		if (Name != "." && Name != "..")
+			AddFiles(Path+"/"+Name, Files);
+	}
+	closedir(Directory);
+#endif
+}
+
+int main(int argc, char *argv[]){
+	// Read the options
+	bool Compress = false;
+	int First = 1;
+	if (argc > First && std::string(argv[First]) == "-z"){
+		Compress = true;
+		++First;
+	}
+	if (argc < First+2){
+		std::cerr << "Usage: " << argv[0] << " [-z] output.pak file_or_directory [...]" << std::endl;
+		return 1;
+	}
+
+	// Files are packed under the names they are given, so pack from the directory the game runs in
+	std::vector<std::string> Files;
+	for (int i = First+1; i < argc; ++i)
+		AddFiles(argv[i], Files);
+	std::sort(Files.begin(), Files.end());
+	Files.erase(std::unique(Files.begin(), Files.end()), Files.end());
+
+	std::string Problem;
+	if (!terra::PackFile::Write(argv[First], Files, Compress, Problem)){
+		std::cerr << "Unable to write \"" << argv[First] << "\": " << Problem << std::endl;
+		return 1;
+	}
+	std::cout << "Packed " << Files.size() << " files into \"" << argv[First] << "\"" << std::endl;
+	return 0;
+}